@@ -0,0 +1,434 @@
+//-----------------------------------------------------------------------------
+/** @file benchmark_tool/Main.cpp
+    Benchmarks for the search in libpentobi_mcts.
+
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include <iomanip>
+#include <random>
+#include <thread>
+#include "libboardgame_base/Log.h"
+#include "libboardgame_base/Options.h"
+#include "libboardgame_base/RandomGenerator.h"
+#include "libboardgame_base/Statistics.h"
+#include "libboardgame_base/Timer.h"
+#include "libboardgame_base/WallTimeSource.h"
+#include "libpentobi_mcts/Player.h"
+
+using namespace std;
+using libboardgame_base::Options;
+using libboardgame_base::RandomGenerator;
+using libboardgame_base::Range;
+using libboardgame_base::Statistics;
+using libboardgame_base::Timer;
+using libboardgame_base::WallTimeSource;
+using libboardgame_mcts::select_child_blocked;
+using libboardgame_mcts::select_child_scalar;
+using libpentobi_base::Board;
+using libpentobi_base::Color;
+using libpentobi_base::Move;
+using libpentobi_base::Variant;
+using libpentobi_base::to_string_id;
+using libpentobi_mcts::Float;
+using libpentobi_mcts::Player;
+using libpentobi_mcts::Search;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Maximum level used for creating the players.
+    Only determines the memory used for the search trees, which is large
+    enough for the number of simulations typically used in benchmarks at
+    this level and keeps the memory requirements low enough to use two
+    players in the same process. */
+const unsigned max_level = 7;
+
+/** Configuration of a player in a benchmark. */
+struct PlayerConfig
+{
+    Float simulations;
+
+    bool use_transposition_table;
+};
+
+/** Play a game between two players.
+    @return The game result from the view point of the first player (0, 0.5
+    or 1). */
+double play_game(Board& bd, array<unique_ptr<Player>, 2>& players)
+{
+    bd.init();
+    while (! bd.is_game_over())
+    {
+        auto c = bd.get_effective_to_play();
+        auto mv = players[c.to_int() % 2]->genmove(bd, c);
+        if (mv.is_null())
+            throw runtime_error("player generated pass move");
+        bd.play(c, mv);
+    }
+    auto score = bd.get_score_twoplayer(Color(0));
+    if (score > 0)
+        return 1;
+    if (score < 0)
+        return 0;
+    return 0.5;
+}
+
+/** Play games between two players and print the result after each game.
+    The first player alternates between the players.
+    @return The result of the first player. */
+Statistics<double> play_games(Variant variant, unsigned nu_games,
+                              array<unique_ptr<Player>, 2>& players)
+{
+    Board bd(variant);
+    Statistics<double> result;
+    for (unsigned i = 0; i < nu_games; ++i)
+    {
+        if (i % 2 == 0)
+            result.add(play_game(bd, players));
+        else
+        {
+            swap(players[0], players[1]);
+            result.add(1 - play_game(bd, players));
+            swap(players[0], players[1]);
+        }
+        cout << "Game " << (i + 1) << ": " << fixed << setprecision(3)
+             << result.get_mean() << " +/- " << result.get_error() << endl;
+    }
+    return result;
+}
+
+/** Play games between a player with and a player without transposition
+    table.
+    This can be used to find the number of simulations needed to reach the
+    same playing strength with and without transposition table by varying
+    the number of simulations of one of the players. */
+void benchmark_transposition(Variant variant, unsigned nu_games,
+                             const array<PlayerConfig, 2>& config)
+{
+    if (get_nu_players(variant) != 2)
+        throw runtime_error("benchmark needs a two-player game variant");
+    array<unique_ptr<Player>, 2> players;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        players[i] = make_unique<Player>(variant, max_level, "", 1);
+        players[i]->set_use_book(false);
+        players[i]->set_fixed_simulations(config[i].simulations);
+        players[i]->get_search().set_use_transposition_table(
+                    config[i].use_transposition_table);
+    }
+    auto result = play_games(variant, nu_games, players);
+    for (unsigned i = 0; i < 2; ++i)
+        cout << "Player " << (i + 1) << ": simulations="
+             << setprecision(0) << config[i].simulations
+             << " transposition_table=" << config[i].use_transposition_table
+             << '\n';
+    cout << "Result player 1: " << setprecision(3) << result.get_mean()
+         << " +/- " << result.get_error() << '\n';
+}
+
+/** Measure the simulations per second of the single-threaded search.
+    Measured in the start position and in the positions after a quarter,
+    half and three quarters of the moves of a game played with a small
+    number of simulations, because the cost of a simulation depends a lot
+    on the number of moves left in the game. The random generator uses a
+    fixed seed, such that the positions are the same in each run. */
+void benchmark_speed(const vector<Variant>& variants, double time)
+{
+    RandomGenerator::set_global_seed(0);
+    WallTimeSource time_source;
+    cout << fixed << setprecision(0)
+         << "Variant          Start      25%      50%      75%\n";
+    for (auto variant : variants)
+    {
+        auto player = make_unique<Player>(variant, max_level, "", 1);
+        player->set_use_book(false);
+        player->set_fixed_simulations(100);
+        auto bd = make_unique<Board>(variant);
+        bd->init();
+        while (! bd->is_game_over())
+        {
+            auto c = bd->get_effective_to_play();
+            bd->play(c, player->genmove(*bd, c));
+        }
+        auto moves = bd->get_moves();
+        auto& search = player->get_search();
+        search.set_reuse_subtree(false);
+        cout << left << setw(12) << to_string_id(variant) << right;
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            bd->init();
+            for (unsigned j = 0; j < i * moves.size() / 4; ++j)
+                bd->play(moves[j]);
+            Move mv;
+            search.search(mv, *bd, bd->get_effective_to_play(), 0, 0, time,
+                          time_source);
+            cout << setw(9)
+                 << double(search.get_nu_simulations()) / time;
+        }
+        cout << endl;
+    }
+}
+
+/** Measure the simulations per second and the playing strength for an
+    increasing number of threads.
+    The number of threads is doubled from 1 up to max_threads. The
+    simulations per second are measured in the start position and in two
+    positions from a game played with a small number of simulations. The
+    strength is measured by playing games against the single-threaded search
+    with the same time per move. */
+void benchmark_threads(Variant variant, unsigned nu_games,
+                       unsigned max_threads, unsigned nu_thread_groups,
+                       double time)
+{
+    if (nu_games > 0 && get_nu_players(variant) != 2)
+        throw runtime_error("benchmark needs a two-player game variant");
+    vector<unique_ptr<Board>> positions;
+    {
+        auto player = make_unique<Player>(variant, max_level, "", 1);
+        player->set_use_book(false);
+        player->set_fixed_simulations(100);
+        Board bd(variant);
+        bd.init();
+        while (! bd.is_game_over() && positions.size() < 3)
+        {
+            if (bd.get_nu_moves() % 16 == 0)
+            {
+                positions.push_back(make_unique<Board>(variant));
+                positions.back()->copy_from(bd);
+            }
+            auto c = bd.get_effective_to_play();
+            bd.play(c, player->genmove(bd, c));
+        }
+    }
+    vector<unsigned> nu_threads_list;
+    for (unsigned i = 1; i < max_threads; i *= 2)
+        nu_threads_list.push_back(i);
+    nu_threads_list.push_back(max_threads);
+    WallTimeSource time_source;
+    vector<double> sim_per_sec;
+    vector<Statistics<double>> results;
+    for (auto nu_threads : nu_threads_list)
+    {
+        array<unique_ptr<Player>, 2> players;
+        players[0] = make_unique<Player>(variant, max_level, "", nu_threads);
+        auto& search = players[0]->get_search();
+        search.set_nu_thread_groups(nu_thread_groups);
+        search.set_reuse_subtree(false);
+        double nu_simulations = 0;
+        for (auto& bd : positions)
+        {
+            Move mv;
+            search.search(mv, *bd, bd->get_effective_to_play(), 0, 0, time,
+                          time_source);
+            nu_simulations += double(search.get_nu_simulations());
+        }
+        sim_per_sec.push_back(nu_simulations
+                              / (double(positions.size()) * time));
+        search.set_reuse_subtree(true);
+        if (nu_threads == 1 || nu_games == 0)
+        {
+            results.emplace_back();
+            continue;
+        }
+        players[1] = make_unique<Player>(variant, max_level, "", 1);
+        for (auto& player : players)
+        {
+            player->set_use_book(false);
+            player->set_fixed_time(time);
+        }
+        results.push_back(play_games(variant, nu_games, players));
+    }
+    cout << fixed << "Threads  Sim/s     Speedup  Result vs. 1 thread\n";
+    for (size_t i = 0; i < nu_threads_list.size(); ++i)
+    {
+        cout << setw(7) << nu_threads_list[i] << "  " << setw(8)
+             << setprecision(0) << sim_per_sec[i] << "  " << setw(7)
+             << setprecision(2) << sim_per_sec[i] / sim_per_sec[0];
+        if (results[i].get_count() > 0)
+            cout << "  " << setprecision(3) << results[i].get_mean()
+                 << " +/- " << results[i].get_error();
+        cout << '\n';
+    }
+}
+
+/** Measure the time of a function that selects a child.
+    @return The time per call in nanoseconds. */
+template<class F>
+double time_select_child(
+        F select_child,
+        const vector<Range<const Search::Node>>& children_list)
+{
+    WallTimeSource time_source;
+    Timer timer(time_source);
+    size_t nu_calls = 0;
+    size_t checksum = 0;
+    do
+    {
+        for (auto& children : children_list)
+            checksum += size_t(select_child(children) - children.begin());
+        nu_calls += children_list.size();
+    }
+    while (timer() < 1);
+    // Use the result to make sure that the calls are not optimized away
+    if (checksum == size_t(-1))
+        cout << checksum;
+    return 1e9 * timer() / double(nu_calls);
+}
+
+/** Microbenchmark for the selection of a child in the in-tree phase.
+    Compares select_child_scalar() with select_child_blocked() for different
+    block sizes on random children statistics. */
+void benchmark_select_child()
+{
+    using Node = Search::Node;
+    mt19937 generator;
+    uniform_real_distribution<Float> value_dist(0, 1);
+    uniform_real_distribution<Float> count_dist(3, 1000);
+    uniform_real_distribution<Float> prior_dist(0, 1);
+    Float expl_factor = 0.5f;
+    cout << fixed << setprecision(1)
+         << "Children  Scalar[ns]  Block8[ns]  Block16[ns]\n";
+    for (unsigned nu_children : { 10, 50, 200, 500, 1500 })
+    {
+        // Use enough sets of children to not fit into the CPU caches
+        unsigned nu_sets = max(1u, 1000000u / nu_children);
+        auto nodes = make_unique<Node[]>(size_t(nu_sets) * nu_children);
+        vector<Range<const Node>> children_list;
+        for (unsigned i = 0; i < nu_sets; ++i)
+        {
+            auto begin = nodes.get() + size_t(i) * nu_children;
+            for (unsigned j = 0; j < nu_children; ++j)
+            {
+                Move mv(static_cast<Move::IntType>(j));
+                begin[j].restore(mv, value_dist(generator),
+                                 count_dist(generator), 0,
+                                 prior_dist(generator));
+            }
+            children_list.emplace_back(begin, begin + nu_children);
+        }
+        auto scalar = time_select_child(
+            [&](const Range<const Node>& children) {
+                return select_child_scalar(children, expl_factor,
+                                           expl_factor / 3);
+            }, children_list);
+        auto block8 = time_select_child(
+            [&](const Range<const Node>& children) {
+                return select_child_blocked<8>(children, expl_factor);
+            }, children_list);
+        auto block16 = time_select_child(
+            [&](const Range<const Node>& children) {
+                return select_child_blocked<16>(children, expl_factor);
+            }, children_list);
+        cout << setw(8) << nu_children << setw(12) << scalar << setw(12)
+             << block8 << setw(13) << block16 << '\n';
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    libboardgame_base::LogInitializer log_initializer;
+    try
+    {
+        vector<string> specs = {
+            "game|g:",
+            "games|n:",
+            "help|h",
+            "quiet|q",
+            "simulations:",
+            "simulations-tt:",
+            "thread-groups:",
+            "threads:",
+            "time:"
+        };
+        Options opt(argc, argv, specs);
+        if (opt.contains("help") || opt.get_args().size() != 1)
+        {
+            cout <<
+                "Usage: benchmark-tool [options] benchmark\n"
+                "Benchmarks:\n"
+                "  select_child    time of the child selection in the\n"
+                "                  search tree\n"
+                "  speed           simulations per second in --game or\n"
+                "                  in all game variants\n"
+                "  threads         measure simulations per second and\n"
+                "                  strength for 1 up to --threads threads\n"
+                "  transposition   play games with and without\n"
+                "                  transposition table\n"
+                "Options:\n"
+                "--game,-g        game variant (default classic_2)\n"
+                "--games,-n       number of games (default 100)\n"
+                "--help,-h        print help message and exit\n"
+                "--quiet,-q       do not print logging messages\n"
+                "--simulations    simulations per move (default 1000)\n"
+                "--simulations-tt simulations per move with transposition\n"
+                "                 table (default same as --simulations)\n"
+                "--thread-groups  number of thread groups (default 1)\n"
+                "--threads        maximum number of threads (default\n"
+                "                 number of hardware threads)\n"
+                "--time           time per move in seconds (default 1)\n";
+            return 0;
+        }
+        if (opt.contains("quiet"))
+            libboardgame_base::disable_logging();
+        string variant_string = opt.get("game", "classic_2");
+        Variant variant;
+        if (! parse_variant_id(variant_string, variant))
+            throw runtime_error("invalid game variant " + variant_string);
+        auto nu_games = opt.get<unsigned>("games", 100);
+        auto simulations = opt.get<Float>("simulations", 1000);
+        auto& benchmark = opt.get_args()[0];
+        if (benchmark == "select_child")
+            benchmark_select_child();
+        else if (benchmark == "speed")
+        {
+            vector<Variant> variants;
+            if (opt.contains("game"))
+                variants.push_back(variant);
+            else
+                variants = { Variant::classic, Variant::classic_2,
+                             Variant::duo, Variant::junior, Variant::trigon,
+                             Variant::trigon_2, Variant::trigon_3,
+                             Variant::nexos, Variant::nexos_2,
+                             Variant::callisto, Variant::callisto_2,
+                             Variant::gembloq, Variant::gembloq_2 };
+            benchmark_speed(variants, opt.get<double>("time", 1));
+        }
+        else if (benchmark == "threads")
+        {
+            auto max_threads = opt.get<unsigned>(
+                        "threads", max(thread::hardware_concurrency(), 1u));
+            auto nu_thread_groups = opt.get<unsigned>("thread-groups", 1);
+            if (max_threads == 0 || nu_thread_groups == 0)
+                throw runtime_error("invalid number of threads");
+            benchmark_threads(variant, nu_games, max_threads,
+                              nu_thread_groups, opt.get<double>("time", 1));
+        }
+        else if (benchmark == "transposition")
+        {
+            array<PlayerConfig, 2> config;
+            config[0].simulations =
+                    opt.get<Float>("simulations-tt", simulations);
+            config[0].use_transposition_table = true;
+            config[1].simulations = simulations;
+            config[1].use_transposition_table = false;
+            benchmark_transposition(variant, nu_games, config);
+        }
+        else
+            throw runtime_error("unknown benchmark " + benchmark);
+    }
+    catch (const exception& e)
+    {
+        LIBBOARDGAME_LOG("Error: ", e.what());
+        return 1;
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,325 @@
+//-----------------------------------------------------------------------------
+/** @file book_tool/BookBuilder.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "BookBuilder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <thread>
+#include "libboardgame_base/Log.h"
+#include "libboardgame_base/Memory.h"
+#include "libboardgame_base/StringUtil.h"
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_base/TreeWriter.h"
+#include "libboardgame_base/WallTimeSource.h"
+
+using libboardgame_base::TreeReader;
+using libboardgame_base::TreeWriter;
+using libboardgame_base::WallTimeSource;
+using libpentobi_base::BoardConst;
+using libpentobi_base::Color;
+using libpentobi_base::Move;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Memory used for the search trees of all threads. */
+size_t get_memory()
+{
+    auto available = libboardgame_base::get_memory();
+    if (available == 0)
+        available = 1000000000;
+    return min(available / 3, size_t(8000000000));
+}
+
+/** Write to a temporary file and rename it, such that an interrupted run
+    never leaves a partially written file. */
+template<class F>
+void write_file(const string& file, F write)
+{
+    auto tmp_file = file + ".tmp" + std::to_string(random_device()());
+    {
+        ofstream out(tmp_file);
+        write(out);
+        if (! out)
+        {
+            std::remove(tmp_file.c_str());
+            throw runtime_error("could not write " + file);
+        }
+    }
+    if (std::rename(tmp_file.c_str(), file.c_str()) != 0)
+    {
+        std::remove(tmp_file.c_str());
+        throw runtime_error("could not write " + file);
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+BookBuilder::BookBuilder(Variant variant, const string& book_file,
+                         const string& queue_file, unsigned nu_threads,
+                         const Param& param)
+    : m_variant(variant),
+      m_book_file(book_file),
+      m_queue_file(queue_file),
+      m_param(param),
+      m_tree(variant)
+{
+    if (ifstream(book_file))
+    {
+        TreeReader reader;
+        reader.read(book_file);
+        auto root = reader.get_tree_transfer_ownership();
+        m_tree.init(root);
+        if (m_tree.get_variant() != variant)
+            throw runtime_error(book_file + " has wrong game variant");
+    }
+    nu_threads = max(nu_threads, 1u);
+    auto memory = get_memory() / nu_threads;
+    for (unsigned i = 0; i < nu_threads; ++i)
+    {
+        m_searches.push_back(make_unique<Search>(variant, 1, memory));
+        m_boards.push_back(make_unique<Board>(variant));
+    }
+    init_positions(m_tree.get_root(), *m_boards[0]);
+    if (ifstream(queue_file))
+        load_queue();
+    else
+    {
+        vector<ColorMove> moves;
+        init_queue(m_tree.get_root(), moves);
+        sort_queue();
+    }
+    LIBBOARDGAME_LOG("Book positions: ", m_positions.size(),
+                     ", queue: ", m_queue.size());
+}
+
+BookBuilder::~BookBuilder() = default;
+
+void BookBuilder::add_result(const Job& job, const Result& result)
+{
+    if (result.moves.empty())
+        return;
+    auto& node = find_node(job.moves);
+    auto best_value = result.moves[0].value;
+    auto& bd = *m_boards[0];
+    for (auto& i : result.moves)
+    {
+        auto loss = best_value - i.value;
+        if (loss > m_param.max_loss)
+            continue;
+        auto child = m_tree.find_child_with_move(node, i.mv);
+        if (child == nullptr)
+        {
+            child = &m_tree.create_new_child(node);
+            m_tree.set_move(*child, i.mv);
+        }
+        if (&i == &result.moves[0])
+            m_tree.set_good_move(*child);
+        Job child_job;
+        child_job.moves = job.moves;
+        child_job.moves.push_back(i.mv);
+        bd.init();
+        for (auto& mv : child_job.moves)
+            bd.play(mv);
+        if (! m_positions.insert(bd.get_canonical_hash()).second)
+            // Transposition or symmetric variation of a known position
+            continue;
+        if (child_job.moves.size() >= m_param.max_depth)
+            continue;
+        child_job.priority =
+                job.priority + 1 + m_param.dropout_weight * max(loss, 0.f);
+        push_job(move(child_job));
+    }
+}
+
+void BookBuilder::expand(unsigned i, const Job& job, Result& result)
+{
+    result.moves.clear();
+    auto& bd = *m_boards[i];
+    bd.init();
+    for (auto& mv : job.moves)
+        bd.play(mv);
+    if (bd.is_game_over() || bd.get_nu_moves() >= m_param.max_depth)
+        return;
+    auto c = bd.get_effective_to_play();
+    auto& search = *m_searches[i];
+    WallTimeSource time_source;
+    Move mv;
+    if (! search.search(mv, bd, c, m_param.simulations, 0, 0, time_source))
+        return;
+    auto min_visit_count =
+            m_param.min_visit_fraction * search.get_root_visit_count();
+    for (auto& child : search.get_tree().get_root_children())
+        if (child.get_value_count() > 0
+                && child.get_visit_count() >= min_visit_count)
+            result.moves.push_back({ColorMove(c, child.get_move()),
+                                    child.get_value(),
+                                    child.get_visit_count()});
+    stable_sort(result.moves.begin(), result.moves.end(),
+                [](const MoveValue& m1, const MoveValue& m2) {
+        return m1.visit_count > m2.visit_count;
+    });
+}
+
+const SgfNode& BookBuilder::find_node(const vector<ColorMove>& moves)
+{
+    auto node = &m_tree.get_root();
+    for (auto& mv : moves)
+    {
+        auto child = m_tree.find_child_with_move(*node, mv);
+        if (child == nullptr)
+        {
+            // The book was edited after the queue was written
+            child = &m_tree.create_new_child(*node);
+            m_tree.set_move(*child, mv);
+        }
+        node = child;
+    }
+    return *node;
+}
+
+void BookBuilder::init_positions(const SgfNode& node, Board& bd)
+{
+    m_positions.insert(bd.get_canonical_hash());
+    for (auto& child : node.get_children())
+    {
+        auto mv = m_tree.get_move(child);
+        if (mv.is_null() || ! bd.is_legal(mv.color, mv.move))
+            continue;
+        auto child_bd = make_unique<Board>(m_variant);
+        child_bd->copy_from(bd);
+        child_bd->play(mv);
+        init_positions(child, *child_bd);
+    }
+}
+
+void BookBuilder::init_queue(const SgfNode& node, vector<ColorMove>& moves)
+{
+    if (! node.has_children())
+    {
+        m_queue.push_back({double(moves.size()), moves});
+        return;
+    }
+    for (auto& child : node.get_children())
+    {
+        auto mv = m_tree.get_move(child);
+        if (mv.is_null())
+            continue;
+        moves.push_back(mv);
+        init_queue(child, moves);
+        moves.pop_back();
+    }
+}
+
+void BookBuilder::load_queue()
+{
+    ifstream in(m_queue_file);
+    auto& bc = BoardConst::get(m_variant);
+    auto nu_colors = m_boards[0]->get_nu_colors();
+    string line;
+    while (getline(in, line))
+    {
+        if (libboardgame_base::trim(line).empty())
+            continue;
+        istringstream line_in(line);
+        Job job;
+        line_in >> job.priority;
+        string s;
+        while (line_in >> s)
+        {
+            auto pos = s.find(':');
+            unsigned c;
+            Move mv;
+            if (pos == string::npos
+                    || ! libboardgame_base::from_string(s.substr(0, pos), c)
+                    || c >= nu_colors
+                    || ! bc.from_string(mv, s.substr(pos + 1)))
+                throw runtime_error("invalid move in " + m_queue_file + ": "
+                                    + s);
+            job.moves.emplace_back(Color(static_cast<Color::IntType>(c)),
+                                   mv);
+        }
+        if (! line_in.eof())
+            throw runtime_error("invalid line in " + m_queue_file);
+        m_queue.push_back(move(job));
+    }
+    sort_queue();
+}
+
+void BookBuilder::push_job(Job job)
+{
+    auto pos = upper_bound(m_queue.begin(), m_queue.end(), job.priority,
+                           [](double priority, const Job& j) {
+        return priority > j.priority;
+    });
+    m_queue.insert(pos, move(job));
+}
+
+void BookBuilder::run(unsigned max_positions)
+{
+    unsigned nu_expanded = 0;
+    vector<Job> jobs;
+    vector<Result> results;
+    while (! m_queue.empty() && nu_expanded < max_positions)
+    {
+        auto n = min({m_searches.size(), m_queue.size(),
+                      size_t(max_positions - nu_expanded)});
+        jobs.clear();
+        for (size_t i = 0; i < n; ++i)
+        {
+            jobs.push_back(move(m_queue.back()));
+            m_queue.pop_back();
+        }
+        results.resize(n);
+        vector<thread> threads;
+        for (unsigned i = 1; i < n; ++i)
+            threads.emplace_back([&, i] { expand(i, jobs[i], results[i]); });
+        expand(0, jobs[0], results[0]);
+        for (auto& t : threads)
+            t.join();
+        for (size_t i = 0; i < n; ++i)
+            add_result(jobs[i], results[i]);
+        nu_expanded += static_cast<unsigned>(n);
+        save();
+        LIBBOARDGAME_LOG("Expanded ", nu_expanded, " positions, book: ",
+                         m_positions.size(), ", queue: ", m_queue.size());
+    }
+}
+
+void BookBuilder::save()
+{
+    write_file(m_book_file, [&](ostream& out) {
+        TreeWriter writer(out, m_tree.get_root());
+        writer.write();
+    });
+    auto& bc = BoardConst::get(m_variant);
+    write_file(m_queue_file, [&](ostream& out) {
+        for (auto i = m_queue.rbegin(); i != m_queue.rend(); ++i)
+        {
+            out << i->priority;
+            for (auto& mv : i->moves)
+                out << ' ' << static_cast<unsigned>(mv.color.to_int())
+                    << ':' << bc.to_string(mv.move);
+            out << '\n';
+        }
+    });
+}
+
+void BookBuilder::sort_queue()
+{
+    stable_sort(m_queue.begin(), m_queue.end(),
+                [](const Job& j1, const Job& j2) {
+        return j1.priority > j2.priority;
+    });
+}
+
+//-----------------------------------------------------------------------------
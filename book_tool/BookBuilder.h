@@ -0,0 +1,154 @@
+//-----------------------------------------------------------------------------
+/** @file book_tool/BookBuilder.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef BOOK_TOOL_BOOK_BUILDER_H
+#define BOOK_TOOL_BOOK_BUILDER_H
+
+#include <unordered_set>
+#include "libpentobi_base/PentobiTree.h"
+#include "libpentobi_mcts/Search.h"
+
+using namespace std;
+using libboardgame_base::SgfNode;
+using libpentobi_base::Board;
+using libpentobi_base::ColorMove;
+using libpentobi_base::HashKey;
+using libpentobi_base::PentobiTree;
+using libpentobi_base::Variant;
+using libpentobi_mcts::Float;
+using libpentobi_mcts::Search;
+
+//-----------------------------------------------------------------------------
+
+/** Expands an opening book with the search of libpentobi_mcts.
+    Uses dropout expansion: each position taken from the work queue is
+    searched and all moves whose value is within max_loss of the best move
+    are added to the book with the best move marked as good move. The
+    resulting positions are added to the queue with a priority that
+    increases with the depth and with the value lost compared to the best
+    move, and the position with the lowest priority is expanded next. This
+    expands the main lines deeper than the lines that start with weaker
+    moves and keeps the book balanced for both sides.
+    Positions are searched in parallel with one single-threaded search per
+    thread. The book and the work queue are saved after each batch of
+    positions, so an interrupted run can be resumed. */
+class BookBuilder
+{
+public:
+    /** Parameters of the book expansion. */
+    struct Param
+    {
+        /** Simulations of the search per position. */
+        Float simulations = 100000;
+
+        /** Maximum value loss of moves added to the book. */
+        Float max_loss = 0.05f;
+
+        /** Priority penalty per value lost compared to the best move.
+            The default adds one ply of depth for each 0.05 value lost. */
+        double dropout_weight = 20;
+
+        /** Minimum fraction of the root visits for moves added to the book.
+            The values of moves with fewer visits are not reliable. */
+        Float min_visit_fraction = 0.05f;
+
+        /** Positions with this number of moves are not expanded. */
+        unsigned max_depth = 20;
+    };
+
+
+    /** Constructor.
+        @param variant
+        @param book_file The book. Created if it does not exist.
+        @param queue_file The work queue. If the file does not exist, the
+        queue is initialized with the leaf nodes of the book.
+        @param nu_threads
+        @param param */
+    BookBuilder(Variant variant, const string& book_file,
+                const string& queue_file, unsigned nu_threads,
+                const Param& param);
+
+    ~BookBuilder();
+
+    /** Expand positions until the queue is empty or the maximum number of
+        positions is reached.
+        @param max_positions The maximum number of positions to expand. */
+    void run(unsigned max_positions);
+
+    const PentobiTree& get_tree() const { return m_tree; }
+
+private:
+    /** A position in the work queue. */
+    struct Job
+    {
+        double priority;
+
+        vector<ColorMove> moves;
+    };
+
+    /** A move at the root of a search with its value. */
+    struct MoveValue
+    {
+        ColorMove mv;
+
+        Float value;
+
+        Float visit_count;
+    };
+
+    /** Search result of a job. */
+    struct Result
+    {
+        /** Root children of the search sorted by decreasing visit count.
+            Empty if the position was not expanded. */
+        vector<MoveValue> moves;
+    };
+
+
+    Variant m_variant;
+
+    string m_book_file;
+
+    string m_queue_file;
+
+    Param m_param;
+
+    PentobiTree m_tree;
+
+    /** Jobs sorted by decreasing priority. */
+    vector<Job> m_queue;
+
+    /** Canonical hash keys of the positions in the book and in the queue. */
+    unordered_set<HashKey> m_positions;
+
+    /** One search per thread. */
+    vector<unique_ptr<Search>> m_searches;
+
+    vector<unique_ptr<Board>> m_boards;
+
+
+    void add_result(const Job& job, const Result& result);
+
+    void expand(unsigned i, const Job& job, Result& result);
+
+    const SgfNode& find_node(const vector<ColorMove>& moves);
+
+    void init_positions(const SgfNode& node, Board& bd);
+
+    void init_queue(const SgfNode& node, vector<ColorMove>& moves);
+
+    void load_queue();
+
+    void push_job(Job job);
+
+    void save();
+
+    void sort_queue();
+};
+
+//-----------------------------------------------------------------------------
+
+#endif // BOOK_TOOL_BOOK_BUILDER_H
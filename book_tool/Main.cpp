@@ -0,0 +1,247 @@
+//-----------------------------------------------------------------------------
+/** @file book_tool/Main.cpp
+    Build opening books with the search of libpentobi_mcts and compile them
+    to the binary format used by libpentobi_base/CompiledBook. Also converts
+    game files to and from the archive format of libpentobi_base/GameArchive.
+
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include <iostream>
+#include <thread>
+#include "BookBuilder.h"
+#include "libboardgame_base/Log.h"
+#include "libboardgame_base/Options.h"
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_base/TreeWriter.h"
+#include "libpentobi_base/CompiledBook.h"
+#include "libpentobi_base/GameArchive.h"
+
+using namespace std;
+using libboardgame_base::Options;
+using libboardgame_base::TreeReader;
+using libboardgame_base::TreeWriter;
+using libpentobi_base::BoardConst;
+using libpentobi_base::CompiledBook;
+using libpentobi_base::GameArchive;
+using libpentobi_base::GameArchiveWriter;
+using libpentobi_base::GameRecord;
+using libpentobi_base::PentobiTree;
+using libpentobi_base::parse_variant_id;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Convert the main variations of the games in SGF files to a game archive.
+    Games with setup are skipped. */
+void archive(const Options& opt)
+{
+    auto& args = opt.get_args();
+    if (args.size() < 3)
+        throw runtime_error("archive needs an archive file and game files");
+    unique_ptr<GameArchiveWriter> writer;
+    // Set from the first game when the writer is created
+    Variant variant = Variant::classic;
+    GameRecord record;
+    TreeReader reader;
+    reader.set_read_only_main_variation(true);
+    for (size_t i = 2; i < args.size(); ++i)
+    {
+        ifstream in(args[i]);
+        if (! in)
+            throw runtime_error("could not open " + args[i]);
+        bool has_more;
+        do
+        {
+            has_more = reader.read(in, false);
+            auto root = reader.get_tree_transfer_ownership();
+            PentobiTree tree(root);
+            if (! writer)
+            {
+                variant = tree.get_variant();
+                writer = make_unique<GameArchiveWriter>(args[1], variant);
+            }
+            else if (tree.get_variant() != variant)
+                throw runtime_error(args[i] + " has wrong game variant");
+            try
+            {
+                get_game_record(tree, record);
+            }
+            catch (const runtime_error& e)
+            {
+                LIBBOARDGAME_LOG("WARNING: ", args[i], ": ", e.what());
+                continue;
+            }
+            writer->add(record);
+        }
+        while (has_more);
+    }
+    if (! writer)
+        throw runtime_error("no games");
+    writer->close();
+    LIBBOARDGAME_LOG("Wrote ", args[1], " (", writer->get_nu_games(),
+                     " games)");
+}
+
+/** Compile a book file.
+    The compiled book is written to a file with the same name and the
+    extension .blkbook in the output directory or in the directory of the
+    book if the output directory is empty. */
+void compile(const string& file, const string& output_dir)
+{
+    TreeReader reader;
+    reader.read(file);
+    auto root = reader.get_tree_transfer_ownership();
+    PentobiTree tree(root);
+    auto name = file;
+    auto pos = name.rfind('.');
+    if (pos != string::npos && name.find('/', pos) == string::npos)
+        name.erase(pos);
+    if (! output_dir.empty())
+    {
+        pos = name.rfind('/');
+        if (pos != string::npos)
+            name.erase(0, pos + 1);
+        name = output_dir + "/" + name;
+    }
+    name += ".blkbook";
+    CompiledBook::compile(tree, name);
+    CompiledBook book(name);
+    LIBBOARDGAME_LOG("Wrote ", name, " (", book.get_nu_entries(),
+                     " positions)");
+}
+
+/** Write the games of a game archive as SGF to standard output. */
+void extract(const Options& opt)
+{
+    if (opt.get_args().size() != 2)
+        throw runtime_error("extract needs an archive file");
+    GameArchive archive(opt.get_args()[1]);
+    PentobiTree tree(archive.get_variant());
+    GameRecord record;
+    for (size_t i = 0; i < archive.get_nu_games(); ++i)
+    {
+        archive.get_game(i, record);
+        get_tree(archive.get_variant(), record, tree);
+        TreeWriter writer(cout, tree.get_root());
+        writer.write();
+    }
+}
+
+void expand(const Options& opt)
+{
+    if (opt.get_args().size() != 2)
+        throw runtime_error("expand needs a book file");
+    auto& book_file = opt.get_args()[1];
+    string variant_string = opt.get("game", "classic_2");
+    Variant variant;
+    if (! parse_variant_id(variant_string, variant))
+        throw runtime_error("invalid game variant " + variant_string);
+    BookBuilder::Param param;
+    param.simulations = opt.get<Float>("simulations", param.simulations);
+    param.max_loss = opt.get<Float>("max-loss", param.max_loss);
+    param.dropout_weight =
+            opt.get<double>("dropout-weight", param.dropout_weight);
+    param.max_depth = opt.get<unsigned>("max-depth", param.max_depth);
+    auto nu_threads = opt.get<unsigned>(
+                "threads", max(thread::hardware_concurrency(), 1u));
+    BookBuilder builder(variant, book_file,
+                        opt.get("queue", book_file + ".queue"), nu_threads,
+                        param);
+    builder.run(opt.get<unsigned>("positions", 100));
+    if (opt.contains("compiled"))
+        CompiledBook::compile(builder.get_tree(), opt.get("compiled"));
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    libboardgame_base::LogInitializer log_initializer;
+    try
+    {
+        vector<string> specs = {
+            "cache-dir:",
+            "compiled:",
+            "dropout-weight:",
+            "game|g:",
+            "help|h",
+            "max-depth:",
+            "max-loss:",
+            "output-dir:",
+            "positions:",
+            "queue:",
+            "quiet|q",
+            "simulations:",
+            "threads:"
+        };
+        Options opt(argc, argv, specs);
+        auto& args = opt.get_args();
+        if (opt.contains("help") || args.empty()
+                || (args[0] != "archive" && args[0] != "compile"
+                    && args[0] != "expand" && args[0] != "extract"))
+        {
+            cout <<
+                "Usage: book-tool [options] command files\n"
+                "Commands:\n"
+                "  archive out.blkgames file.blksgf...\n"
+                "                          convert the main variations of\n"
+                "                          games to a game archive\n"
+                "  compile book.blksgf...  compile books to .blkbook files\n"
+                "  expand book.blksgf      expand a book (created if it\n"
+                "                          does not exist) with the search\n"
+                "  extract in.blkgames     write the games of an archive\n"
+                "                          as SGF to standard output\n"
+                "Options:\n"
+                "--cache-dir      directory for caching precomputed moves\n"
+                "--compiled       also write the expanded book to this\n"
+                "                 compiled book file\n"
+                "--dropout-weight priority penalty per value lost compared\n"
+                "                 to the best move (default 20)\n"
+                "--game,-g        game variant (default classic_2)\n"
+                "--help,-h        print help message and exit\n"
+                "--max-depth      maximum number of moves (default 20)\n"
+                "--max-loss       maximum value loss of moves added to the\n"
+                "                 book (default 0.05)\n"
+                "--output-dir     directory for compiled books (default\n"
+                "                 directory of the book)\n"
+                "--positions      number of positions to expand (default\n"
+                "                 100)\n"
+                "--queue          work queue file (default book file with\n"
+                "                 extension .queue appended)\n"
+                "--quiet,-q       do not print logging messages\n"
+                "--simulations    simulations per position (default\n"
+                "                 100000)\n"
+                "--threads        number of threads (default number of\n"
+                "                 hardware threads)\n";
+            return 0;
+        }
+        if (opt.contains("quiet"))
+            libboardgame_base::disable_logging();
+        BoardConst::set_cache_dir(opt.get("cache-dir", ""));
+        if (args[0] == "archive")
+            archive(opt);
+        else if (args[0] == "compile")
+        {
+            auto output_dir = opt.get("output-dir", "");
+            for (size_t i = 1; i < args.size(); ++i)
+                compile(args[i], output_dir);
+        }
+        else if (args[0] == "expand")
+            expand(opt);
+        else
+            extract(opt);
+    }
+    catch (const exception& e)
+    {
+        LIBBOARDGAME_LOG("Error: ", e.what());
+        return 1;
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
@@ -14,6 +14,7 @@
 #include "libboardgame_base/Options.h"
 #include "libboardgame_base/TreeReader.h"
 #include "libpentobi_base/Game.h"
+#include "libpentobi_base/GameArchive.h"
 #include "libpentobi_base/MoveMarker.h"
 #include "libpentobi_mcts/LocalPoints.h"
 
@@ -26,6 +27,8 @@ using libpentobi_base::Board;
 using libpentobi_base::BoardConst;
 using libpentobi_base::Color;
 using libpentobi_base::Game;
+using libpentobi_base::GameArchive;
+using libpentobi_base::GameRecord;
 using libpentobi_base::Geometry;
 using libpentobi_base::GridExt;
 using libpentobi_base::Move;
@@ -315,8 +318,64 @@ void add_sample(const Board& bd, Color to_play, Move played_mv)
     samples.push_back(sample);
 }
 
+void add_position(const Board& bd, Color c, Move mv)
+{
+    ++nu_positions;
+    auto max_piece_size = bd.get_board_const().get_max_piece_size();
+    if (max_piece_size == 5 && bd.is_callisto())
+        add_sample<5, 16, true>(bd, c, mv);
+    else if (max_piece_size == 5)
+        add_sample<5, 16, false>(bd, c, mv);
+    else if (max_piece_size == 6)
+        add_sample<6, 22, false>(bd, c, mv);
+    else if (max_piece_size == 7)
+        add_sample<7, 12, false>(bd, c, mv);
+    else
+        add_sample<22, 44, false>(bd, c, mv);
+}
+
+void print_progress()
+{
+    cerr << '.';
+    if (nu_games % 79 == 0)
+        cerr << '\n';
+}
+
+/** Generate training data from a game archive.
+    Much faster than reading SGF files because the games can be replayed on
+    a board without building a game tree. */
+void gen_train_data_archive(const string& file, Variant& variant)
+{
+    GameArchive archive(file);
+    if (nu_games > 0 && archive.get_variant() != variant)
+        throw runtime_error("Files have inconsistent game variants");
+    variant = archive.get_variant();
+    auto bd = make_unique<Board>(variant);
+    GameRecord record;
+    for (size_t i = 0; i < archive.get_nu_games(); ++i)
+    {
+        archive.get_game(i, record);
+        ++nu_games;
+        bd->init();
+        for (auto& mv : record.moves)
+        {
+            // add_position() checks that the move is legal
+            bd->set_to_play(mv.color);
+            add_position(*bd, mv.color, mv.move);
+            bd->play(mv);
+        }
+        print_progress();
+    }
+}
+
 void gen_train_data(const string& file, Variant& variant)
 {
+    if (file.size() > 9
+            && file.compare(file.size() - 9, 9, ".blkgames") == 0)
+    {
+        gen_train_data_archive(file, variant);
+        return;
+    }
     ifstream in(file);
     if (! in)
         throw runtime_error("could not open " + file);
@@ -333,33 +392,20 @@ void gen_train_data(const string& file, Variant& variant)
             throw runtime_error("Files have inconsistent game variants");
         ++nu_games;
         variant = game.get_variant();
-        auto max_piece_size = bd.get_board_const().get_max_piece_size();
         auto node = &game.get_root();
         do
         {
             auto mv = game.get_tree().get_move(*node);
             if (! mv.is_null() && node->has_parent())
             {
-                ++nu_positions;
                 game.goto_node(node->get_parent());
                 game.set_to_play(mv.color);
-                if (max_piece_size == 5 && bd.is_callisto())
-                    add_sample<5, 16, true>(bd, mv.color, mv.move);
-                else if (max_piece_size == 5)
-                    add_sample<5, 16, false>(bd, mv.color, mv.move);
-                else if (max_piece_size == 6)
-                    add_sample<6, 22, false>(bd, mv.color, mv.move);
-                else if (max_piece_size == 7)
-                    add_sample<7, 12, false>(bd, mv.color, mv.move);
-                else
-                    add_sample<22, 44, false>(bd, mv.color, mv.move);
+                add_position(bd, mv.color, mv.move);
             }
             node = node->get_first_child_or_null();
         }
         while (node != nullptr);
-        cerr << '.';
-        if (nu_games % 79 == 0)
-            cerr << '\n';
+        print_progress();
     }
     while (has_more);
 }
@@ -0,0 +1,54 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/BinaryIO.h
+    Functions for reading and writing binary files in the native byte order
+    of the machine.
+    The files are intended for caching data between runs on the same machine,
+    not for exchanging data between different machines.
+
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_BASE_BINARY_IO_H
+#define LIBBOARDGAME_BASE_BINARY_IO_H
+
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace libboardgame_base {
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+/** Read a value from a memory buffer.
+    The buffer does not need to be aligned for T.
+    @param[in,out] data The current position in the buffer. Advanced by the
+    size of the value.
+    @param end The end of the buffer.
+    @param[out] t The value.
+    @throws runtime_error If the buffer is too short. */
+template<typename T>
+void read_binary(const char*& data, const char* end, T& t)
+{
+    static_assert(is_trivially_copyable_v<T>);
+    if (static_cast<size_t>(end - data) < sizeof(T))
+        throw runtime_error("unexpected end of binary data");
+    memcpy(&t, data, sizeof(T));
+    data += sizeof(T);
+}
+
+template<typename T>
+void write_binary(ostream& out, const T& t)
+{
+    static_assert(is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<const char*>(&t), sizeof(T));
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
+
+#endif // LIBBOARDGAME_BASE_BINARY_IO_H
@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/MappedFile.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace libboardgame_base {
+
+//-----------------------------------------------------------------------------
+
+MappedFile::MappedFile(const string& file)
+{
+#ifdef _WIN32
+
+    m_file = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        throw runtime_error("could not open " + file);
+    LARGE_INTEGER size;
+    if (! GetFileSizeEx(m_file, &size))
+    {
+        CloseHandle(m_file);
+        throw runtime_error("could not get size of " + file);
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    // Mapping an empty file is not allowed
+    if (m_size == 0)
+        return;
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0,
+                                   nullptr);
+    if (m_mapping == nullptr)
+    {
+        CloseHandle(m_file);
+        throw runtime_error("could not map " + file);
+    }
+    m_data = static_cast<const char*>(
+                MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr)
+    {
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        throw runtime_error("could not map " + file);
+    }
+
+#else
+
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw runtime_error("could not open " + file);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw runtime_error("could not get size of " + file);
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    // Mapping an empty file is not allowed
+    if (m_size == 0)
+    {
+        close(fd);
+        return;
+    }
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after closing the file descriptor
+    close(fd);
+    if (data == MAP_FAILED)
+        throw runtime_error("could not map " + file);
+    m_data = static_cast<const char*>(data);
+
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    CloseHandle(m_file);
+#else
+    if (m_data != nullptr)
+        munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
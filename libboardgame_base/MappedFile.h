@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_base/MappedFile.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_BASE_MAPPED_FILE_H
+#define LIBBOARDGAME_BASE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace libboardgame_base {
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+/** Read-only memory mapping of a file.
+    The content of the file is paged in by the operating system when it is
+    accessed, which makes this class useful for reading large binary files
+    that are only partially used or are read sequentially once. */
+class MappedFile
+{
+public:
+    /** Constructor.
+        @throws runtime_error If the file cannot be opened or mapped. */
+    explicit MappedFile(const string& file);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* get_data() const { return m_data; }
+
+    size_t get_size() const { return m_size; }
+
+private:
+    const char* m_data = nullptr;
+
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void* m_file;
+
+    void* m_mapping = nullptr;
+#endif
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_base
+
+#endif // LIBBOARDGAME_BASE_MAPPED_FILE_H
@@ -7,7 +7,12 @@
 #ifndef LIBBOARDGAME_MCTS_NODE_H
 #define LIBBOARDGAME_MCTS_NODE_H
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <limits>
+#include <type_traits>
 #include "Atomic.h"
 #include "libboardgame_base/Assert.h"
 
@@ -22,15 +27,26 @@ using NodeIdx = uint_least32_t;
 /** %Node in a MCTS tree.
     For details about how the nodes are used in lock-free multi-threaded mode,
     see M. Enzenberger, M. Mueller: A Lock-free Multithreaded Monte-Carlo Tree
-    Search Algorithm. Advances in Computer Games 2009. */
-template<typename M, typename F, bool MT>
-class Node
+    Search Algorithm. Advances in Computer Games 2009.
+    @tparam M The move type.
+    @tparam F The floating type used for values and counts.
+    @tparam MT Whether the node is used in a multi-threaded search.
+    @tparam C Use a compact layout. The visit count is stored as a 32-bit
+    integer and the move prior as the upper 16 bits of a float (bfloat16,
+    about 3 significant decimal digits). With @c double as the floating type,
+    this reduces the node size from 40 to 32 bytes and the node is aligned
+    such that it never spans two cache lines. With @c float, the size stays
+    at 24 bytes because of padding. */
+template<typename M, typename F, bool MT, bool C = false>
+class alignas(C && sizeof(F) == 8 ? 32 : alignof(Atomic<F, MT>)) Node
 {
 public:
     using Move = M;
 
     using Float = F;
 
+    static constexpr bool compact = C;
+
     /** Value returned by get_nu_children() if node has not been expanded. */
     static constexpr short value_unexpanded = -2;
 
@@ -39,6 +55,22 @@ public:
 
     static constexpr unsigned max_children = numeric_limits<short>::max();
 
+    /** Value count of a node with a proven value.
+        Used by the solver (see SearchBase::set_use_solver()). The count is
+        so large that adding more values does not change it and changes the
+        value by less than the rounding error. This keeps the proven value
+        stable under the lock-free updates of the search without needing
+        extra memory in the node. */
+    static constexpr Float proven_count = Float(1e30);
+
+    /** Largest visit count that can be stored without loss of precision.
+        Limited by the mantissa of Float and, in the compact layout, by the
+        range of the integer visit count. */
+    static constexpr size_t max_visit_count =
+            min((size_t(1) << numeric_limits<Float>::digits) - 1,
+                C ? size_t(numeric_limits<uint_least32_t>::max())
+                  : numeric_limits<size_t>::max());
+
     Node() = default;
 
     Node(const Node&) = delete;
@@ -55,12 +87,19 @@ public:
         root. */
     void init_root();
 
+    /** Initialize the data of the node including the visit count.
+        Used for restoring a node from a saved tree. Does not change the
+        child information. This function may not be called on a node that is
+        already part of the tree in multi-threaded mode. */
+    void restore(const Move& mv, Float value, Float value_count,
+                 Float visit_count, Float move_prior);
+
     const Move& get_move() const { return m_move; }
 
     /** Prior value for the move.
         This value is used in the exploration term, see description of class
         SearchBase. */
-    Float get_move_prior() const { return m_move_prior; }
+    Float get_move_prior() const;
 
     /** Number of simulations that went through this node. */
     Float get_visit_count() const;
@@ -80,6 +119,10 @@ public:
 
     bool is_unexpanded() const { return get_nu_children() == value_unexpanded; }
 
+    /** Check if the node has a proven value.
+        @see set_proven() */
+    bool is_proven() const { return get_value_count() >= proven_count; }
+
     void set_expanding();
 
     /** Get the number of children or the expansion state.
@@ -113,6 +156,17 @@ public:
 
     void inc_visit_count();
 
+    /** Set the value to the game-theoretic value of the move.
+        Like other updates in the lock-free search, this can get lost if
+        another thread updates the value at the same time. This only delays
+        the proof because the value is proven again when a later simulation
+        goes through this node. */
+    void set_proven(Float v);
+
+    /** Add a number of visits at once.
+        Used for merging statistics that were collected separately. */
+    void add_visit_count(Float n);
+
     /** Get node index of first child.
         @pre get_nu_children() > 0. Note that in lock-free search, it can
         happen that get_nu_children() was greater 0 but becomes negative
@@ -125,13 +179,18 @@ public:
     NodeIdx get_first_child() const;
 
 private:
+    using VisitCount = conditional_t<C, uint_least32_t, Float>;
+
+    using MovePrior = conditional_t<C, uint_least16_t, Float>;
+
+
     Atomic<Float, MT> m_value;
 
     Atomic<Float, MT> m_value_count;
 
-    Atomic<Float, MT> m_visit_count;
+    Atomic<VisitCount, MT> m_visit_count;
 
-    Float m_move_prior;
+    MovePrior m_move_prior;
 
     /** See get_nu_children() */
     Atomic<short, MT> m_nu_children;
@@ -139,10 +198,13 @@ private:
     Move m_move;
 
     Atomic<NodeIdx, MT> m_first_child;
+
+
+    static MovePrior to_move_prior(Float move_prior);
 };
 
-template<typename M, typename F, bool MT>
-void Node<M, F, MT>::add_value(Float v, Float weight)
+template<typename M, typename F, bool MT, bool C>
+void Node<M, F, MT, C>::add_value(Float v, Float weight)
 {
     // Intentionally uses no synchronization and does not care about
     // lost updates in multi-threaded mode
@@ -154,8 +216,18 @@ void Node<M, F, MT>::add_value(Float v, Float weight)
     m_value_count.store(count, memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-void Node<M, F, MT>::add_value_remove_loss(Float v)
+template<typename M, typename F, bool MT, bool C>
+void Node<M, F, MT, C>::add_visit_count(Float n)
+{
+    // Intentionally uses no synchronization and does not care about
+    // lost updates in multi-threaded mode
+    VisitCount count = m_visit_count.load(memory_order_relaxed);
+    count += static_cast<VisitCount>(n);
+    m_visit_count.store(count, memory_order_relaxed);
+}
+
+template<typename M, typename F, bool MT, bool C>
+void Node<M, F, MT, C>::add_value_remove_loss(Float v)
 {
     // Intentionally uses no synchronization and does not care about
     // lost updates in multi-threaded mode
@@ -167,16 +239,16 @@ void Node<M, F, MT>::add_value_remove_loss(Float v)
     m_value.store(value, memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-void Node<M, F, MT>::copy_data_from(const Node& node)
+template<typename M, typename F, bool MT, bool C>
+void Node<M, F, MT, C>::copy_data_from(const Node& node)
 {
     // Reminder to update this function when the class gets additional members
-    struct Dummy
+    struct alignas(Node) Dummy
     {
         Atomic<Float, MT> m_value;
         Atomic<Float, MT> m_value_count;
-        Atomic<Float, MT> m_visit_count;
-        Float m_move_prior;
+        Atomic<VisitCount, MT> m_visit_count;
+        MovePrior m_move_prior;
         Atomic<short, MT> m_nu_children;
         Move m_move;
         NodeIdx m_first_child;
@@ -195,49 +267,63 @@ void Node<M, F, MT>::copy_data_from(const Node& node)
                         memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-inline auto Node<M, F, MT>::get_value_count() const -> Float
+template<typename M, typename F, bool MT, bool C>
+inline auto Node<M, F, MT, C>::get_move_prior() const -> Float
+{
+    if constexpr (C)
+    {
+        uint_least32_t bits = uint_least32_t(m_move_prior) << 16;
+        float move_prior;
+        memcpy(&move_prior, &bits, sizeof(move_prior));
+        return move_prior;
+    }
+    else
+        return m_move_prior;
+}
+
+template<typename M, typename F, bool MT, bool C>
+inline auto Node<M, F, MT, C>::get_value_count() const -> Float
 {
     return m_value_count.load(memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-inline NodeIdx Node<M, F, MT>::get_first_child() const
+template<typename M, typename F, bool MT, bool C>
+inline NodeIdx Node<M, F, MT, C>::get_first_child() const
 {
     return m_first_child.load(memory_order_acquire);
 }
 
-template<typename M, typename F, bool MT>
-inline short Node<M, F, MT>::get_nu_children() const
+template<typename M, typename F, bool MT, bool C>
+inline short Node<M, F, MT, C>::get_nu_children() const
 {
     return m_nu_children.load(memory_order_acquire);
 }
 
-template<typename M, typename F, bool MT>
-inline auto Node<M, F, MT>::get_value() const -> Float
+template<typename M, typename F, bool MT, bool C>
+inline auto Node<M, F, MT, C>::get_value() const -> Float
 {
     return m_value.load(memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-inline auto Node<M, F, MT>::get_visit_count() const -> Float
+template<typename M, typename F, bool MT, bool C>
+inline auto Node<M, F, MT, C>::get_visit_count() const -> Float
 {
-    return m_visit_count.load(memory_order_relaxed);
+    return static_cast<Float>(m_visit_count.load(memory_order_relaxed));
 }
 
-template<typename M, typename F, bool MT>
-inline void Node<M, F, MT>::inc_visit_count()
+template<typename M, typename F, bool MT, bool C>
+inline void Node<M, F, MT, C>::inc_visit_count()
 {
     // We don't care about the unlikely case that updates are lost because
     // incrementing is not atomic
-    Float count = m_visit_count.load(memory_order_relaxed);
+    VisitCount count = m_visit_count.load(memory_order_relaxed);
     ++count;
     m_visit_count.store(count, memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-void Node<M, F, MT>::init(const Move& mv, Float value, Float count,
-                          Float move_prior)
+template<typename M, typename F, bool MT, bool C>
+void Node<M, F, MT, C>::init(const Move& mv, Float value, Float count,
+                             Float move_prior)
 {
     // The node is not yet visible to other threads because init() is called
     // before the children are linked to its parent with link_children()
@@ -245,15 +331,15 @@ void Node<M, F, MT>::init(const Move& mv, Float value, Float count,
     // Therefore, the most efficient way here is to initialize all values with
     // memory_order_relaxed.
     m_move = mv;
-    m_move_prior = move_prior;
+    m_move_prior = to_move_prior(move_prior);
     m_value_count.store(count, memory_order_relaxed);
     m_value.store(value, memory_order_relaxed);
     m_visit_count.store(0, memory_order_relaxed);
     m_nu_children.store(value_unexpanded, memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-void Node<M, F, MT>::init_root()
+template<typename M, typename F, bool MT, bool C>
+void Node<M, F, MT, C>::init_root()
 {
 #ifdef LIBBOARDGAME_DEBUG
     m_move = Move::null();
@@ -262,9 +348,22 @@ void Node<M, F, MT>::init_root()
     m_nu_children.store(value_unexpanded, memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-inline void Node<M, F, MT>::link_children(NodeIdx first_child,
-                                          unsigned nu_children)
+template<typename M, typename F, bool MT, bool C>
+void Node<M, F, MT, C>::restore(const Move& mv, Float value,
+                                Float value_count, Float visit_count,
+                                Float move_prior)
+{
+    m_move = mv;
+    m_move_prior = to_move_prior(move_prior);
+    m_value_count.store(value_count, memory_order_relaxed);
+    m_value.store(value, memory_order_relaxed);
+    m_visit_count.store(static_cast<VisitCount>(visit_count),
+                        memory_order_relaxed);
+}
+
+template<typename M, typename F, bool MT, bool C>
+inline void Node<M, F, MT, C>::link_children(NodeIdx first_child,
+                                             unsigned nu_children)
 {
     LIBBOARDGAME_ASSERT(nu_children < max_children);
     LIBBOARDGAME_ASSERT(nu_children < Move::range);
@@ -281,9 +380,9 @@ inline void Node<M, F, MT>::link_children(NodeIdx first_child,
     m_nu_children.store(static_cast<short>(nu_children), memory_order_release);
 }
 
-template<typename M, typename F, bool MT>
-inline void Node<M, F, MT>::link_children_st(NodeIdx first_child,
-                                             unsigned nu_children)
+template<typename M, typename F, bool MT, bool C>
+inline void Node<M, F, MT, C>::link_children_st(NodeIdx first_child,
+                                                unsigned nu_children)
 {
     LIBBOARDGAME_ASSERT(nu_children < max_children);
     LIBBOARDGAME_ASSERT(nu_children < Move::range);
@@ -294,14 +393,38 @@ inline void Node<M, F, MT>::link_children_st(NodeIdx first_child,
     m_nu_children.store(static_cast<short>(nu_children), memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-void Node<M, F, MT>::set_expanding()
+template<typename M, typename F, bool MT, bool C>
+inline auto Node<M, F, MT, C>::to_move_prior(Float move_prior) -> MovePrior
+{
+    if constexpr (C)
+    {
+        LIBBOARDGAME_ASSERT(move_prior >= 0);
+        auto f = static_cast<float>(move_prior);
+        uint_least32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        // Round to nearest, ties to even
+        bits += 0x7fff + ((bits >> 16) & 1);
+        return static_cast<MovePrior>(bits >> 16);
+    }
+    else
+        return move_prior;
+}
+
+template<typename M, typename F, bool MT, bool C>
+void Node<M, F, MT, C>::set_proven(Float v)
+{
+    m_value.store(v, memory_order_relaxed);
+    m_value_count.store(proven_count, memory_order_relaxed);
+}
+
+template<typename M, typename F, bool MT, bool C>
+void Node<M, F, MT, C>::set_expanding()
 {
     m_nu_children.store(value_expanding, memory_order_relaxed);
 }
 
-template<typename M, typename F, bool MT>
-inline void Node<M, F, MT>::unlink_children_st()
+template<typename M, typename F, bool MT, bool C>
+inline void Node<M, F, MT, C>::unlink_children_st()
 {
     // Store relaxed (wouldn't even need to be atomic)
     m_nu_children.store(value_unexpanded, memory_order_relaxed);
@@ -15,6 +15,8 @@
 #include "Atomic.h"
 #include "LastGoodReply.h"
 #include "PlayerMove.h"
+#include "SelectChild.h"
+#include "TranspositionTable.h"
 #include "Tree.h"
 #include "TreeUtil.h"
 #include "libboardgame_base/ArrayList.h"
@@ -78,6 +80,12 @@ struct SearchParamConstDefault
         multi-threaded search is not needed. */
     static constexpr bool multithread = true;
 
+    /** Use the compact node layout.
+        See template parameter C of class Node. Reduces the memory used per
+        node if Float is double at the cost of a lower precision of the
+        move prior. */
+    static constexpr bool compact_node = false;
+
     /** Use RAVE. */
     static constexpr bool rave = false;
 
@@ -95,6 +103,23 @@ struct SearchParamConstDefault
         Must be greater 0 if use_lgr is true. */
     static constexpr size_t lgr_hash_table_size = 0;
 
+    /** Compile with support for a transposition table.
+        If enabled, the state must provide the functions get_hash() and
+        get_child_hash(), see SearchBase::set_use_transposition_table().
+        @see TranspositionTable */
+    static constexpr bool use_transposition_table = false;
+
+    /** Maximum number of entries of the transposition table.
+        The table uses at most 1/8 of the search memory.
+        Must be a power of 2 and greater 0 if use_transposition_table is
+        true. */
+    static constexpr size_t transposition_table_size = 0;
+
+    /** Compile with support for the MCTS-Solver.
+        If enabled, the state must provide the functions evaluate_terminal()
+        and has_complete_children(), see SearchBase::set_use_solver(). */
+    static constexpr bool use_solver = false;
+
     /** Use virtual loss in multi-threaded mode.
         See Chaslot et al.: Parallel Monte-Carlo Tree Search. 2008. */
     static constexpr bool virtual_loss = false;
@@ -117,6 +142,11 @@ struct SearchParamConstDefault
         knowledge initialization is used. */
     static constexpr Float prune_count_start = 16;
 
+    /** Number of children handled at once in the in-tree move selection.
+        If 0, the children are handled one at a time with
+        select_child_scalar(), otherwise with select_child_blocked(). */
+    static constexpr unsigned select_child_block_size = 0;
+
     /** Minimum count of a node to be expanded. */
     static constexpr Float expansion_threshold = 0;
 
@@ -181,7 +211,8 @@ public:
 
     using Float = typename SearchParamConst::Float;
 
-    using Node = libboardgame_mcts::Node<M, Float, multithread>;
+    using Node = libboardgame_mcts::Node<M, Float, multithread,
+                                         SearchParamConst::compact_node>;
 
     using Tree = libboardgame_mcts::Tree<Node>;
 
@@ -197,10 +228,19 @@ public:
 
     static_assert(! SearchParamConst::use_lgr || lgr_hash_table_size > 0);
 
+    static constexpr size_t transposition_table_size =
+            SearchParamConst::transposition_table_size;
+
+    static_assert(! SearchParamConst::use_transposition_table
+                  || transposition_table_size > 0);
+
 
     /** Constructor.
         @param nu_threads
-        @param memory The memory to be used for (all) the search trees. */
+        @param memory The memory to be used for the search tree and the
+        transposition table. The memory for the transposition table is only
+        subtracted from the memory for the tree while the table is enabled,
+        see set_use_transposition_table(). */
     SearchBase(unsigned nu_threads, size_t memory);
 
     virtual ~SearchBase();
@@ -242,6 +282,19 @@ public:
 
     virtual string get_info_ext() const;
 
+    /** Check if the solver can be used in the current game.
+        The solver requires that the game is a zero-sum game between two
+        sides, such that a value v for a player implies the value 1 - v for
+        the players of the other side. The default implementation returns
+        true if the game has two players.
+        @see set_use_solver() */
+    virtual bool is_solver_supported() const;
+
+    /** Check if two players belong to the same side.
+        Only used by the solver. The default implementation assumes that each
+        player is its own side. */
+    virtual bool is_same_side(PlayerInt player1, PlayerInt player2) const;
+
     /** @} */ // @name
 
 
@@ -288,6 +341,62 @@ public:
 
     Float get_rave_weight() const;
 
+    /** Share statistics between transpositions.
+        If enabled, the results of the simulations are also stored in a
+        transposition table using the hash key of the position provided by
+        the state (State::get_hash()), and new nodes are initialized with the
+        statistics of their position in the transposition table (using
+        State::get_child_hash()). The transposition table is kept between
+        searches if the position is a follow-up position of the last search.
+        The table is allocated when it is enabled and freed when it is
+        disabled. Its memory is taken from the memory of the search tree,
+        which is reallocated and cleared if the setting changes. Can only be enabled if
+        SearchParamConst::use_transposition_table is true. The default value
+        is false. */
+    void set_use_transposition_table(bool enable);
+
+    bool get_use_transposition_table() const;
+
+    /** Use the MCTS-Solver.
+        If enabled, nodes with a known game-theoretic value are marked as
+        proven (see M. Winands, Y. Bjornsson, J.-T. Saito: Monte-Carlo Tree
+        Search Solver. Computers and Games 2008). Terminal positions are
+        evaluated with State::evaluate_terminal(), which must return the
+        exact game result. A node is proven if one of its children is a
+        proven win for the player to play or if all of its children are
+        proven. The latter is only done if State::has_complete_children()
+        returned true in the position of the node, i.e. if the children
+        of the node include all legal moves. Simulations that reach a proven
+        node use its value instead of running a playout and the search stops
+        when the value of the root position is proven.
+        Can only be enabled if SearchParamConst::use_solver is true and is
+        only used if is_solver_supported() returns true. The default value
+        is false. */
+    void set_use_solver(bool enable);
+
+    bool get_use_solver() const;
+
+    /** Number of thread groups in the multi-threaded search.
+        With more than one group, the search runs in a hybrid
+        root-parallel/tree-parallel mode: all threads share the tree, but
+        each group of threads selects the moves at the root with a private
+        copy of the statistics of the root and its children. The statistics
+        collected by a group are merged into the shared tree periodically (see
+        set_thread_group_merge_interval()) and at the end of the search. This
+        reduces the contention on the nodes at the root at high thread counts,
+        at the cost of each group seeing the simulations of the other groups
+        with a delay. The default value is 1 (no hybrid mode). */
+    void set_nu_thread_groups(unsigned n);
+
+    unsigned get_nu_thread_groups() const;
+
+    /** Number of simulations of a thread between two merges of the root
+        statistics of its group.
+        @see set_nu_thread_groups() */
+    void set_thread_group_merge_interval(unsigned n);
+
+    unsigned get_thread_group_merge_interval() const;
+
     /** @} */ // @name
 
 
@@ -306,6 +415,22 @@ public:
 
     const Tree& get_tree() const;
 
+    /** Write the search tree and the root values in a binary format.
+        Used for warm restarts. The subclass is responsible for storing
+        the position of the tree, see Tree::save() for the format. The data
+        starts with the size of Float and the node layout, so data of a
+        build with a different configuration is rejected by load_tree(). */
+    void save_tree(ostream& out) const;
+
+    /** Restore the search tree and the root values written by save_tree().
+        The next search will reuse the tree if the subclass reports a
+        follow-up position or the same position in check_followup(), even if
+        reusing the tree in the same position is disabled with
+        set_reuse_tree().
+        @see Tree::load() */
+    template<class F>
+    void load_tree(const char*& data, const char* end, F is_valid_move);
+
 #ifdef LIBBOARDGAME_DEBUG
     string dump() const;
 #endif
@@ -318,8 +443,9 @@ public:
     bool select_move(Move& mv) const;
 
     /** Select the best child of the root node after the search.
-        Selects child with highest number of wins; the value is used as a
-        tie-breaker for equal counts (important at very low number of
+        Selects child with highest number of wins; the visit count and then
+        the value are used as tie-breakers for equal numbers of wins
+        (important for proven children and at very low number of
         simulations, e.g. all children have count 1 or 0). */
     const Node* select_final() const;
 
@@ -367,7 +493,17 @@ protected:
 
         ArrayList<PlayerMove, max_moves> moves;
 
+        /** Hash keys of the positions at the nodes.
+            Only used if the transposition table is enabled. */
+        ArrayList<HashKey, max_moves> hashes;
+
         array<Float, max_players> eval;
+
+        /** Index of the first node in nodes whose position and the
+            positions of all following nodes have children for all legal
+            moves.
+            Only used if the solver is enabled. */
+        unsigned solvable_begin;
     };
 
     virtual void on_start_search(bool is_followup);
@@ -387,6 +523,32 @@ private:
     };
 #endif
 
+    /** Statistics of the root and its children that are private to a group
+        of threads.
+        @see set_nu_thread_groups() */
+    struct ThreadGroup
+    {
+        unsigned nu_children = 0;
+
+        unsigned capacity = 0;
+
+        /** Copy of the root used for the move selection at the root by the
+            threads of this group.
+            Contains the statistics of the shared tree at the last merge plus
+            the simulations of this group since then. */
+        Node root;
+
+        /** Copy of the children of the root, same order as in the tree. */
+        unique_ptr<Node[]> children;
+
+        /** Values and visits added by this group since the last merge. */
+        Node delta_root;
+
+        /** Values and visits added by this group since the last merge,
+            same order as the children in the tree. */
+        unique_ptr<Node[]> delta_children;
+    };
+
     /** Thread-specific search state. */
     struct ThreadState
     {
@@ -394,6 +556,10 @@ private:
 
         unsigned thread_id;
 
+        /** Group of the thread in the hybrid root-parallel mode or
+            @c nullptr if not used in the current search. */
+        ThreadGroup* group = nullptr;
+
         /** Was the search in this thread terminated because the search tree
             was full? */
         bool is_out_of_mem;
@@ -475,9 +641,15 @@ private:
 
     LastGoodReply<Move, max_players, lgr_hash_table_size, multithread> m_lgr;
 
+    /** Only allocated if the transposition table is enabled. */
+    unique_ptr<TranspositionTable<Float, multithread>> m_tt;
+
     /** See get_nu_simulations(). */
     Atomic<size_t, multithread> m_nu_simulations;
 
+    /** See set_nu_thread_groups(). */
+    vector<unique_ptr<ThreadGroup>> m_thread_groups;
+
     /** @} */ // @name
 
 
@@ -489,6 +661,32 @@ private:
 
     bool m_reuse_tree = false;
 
+    bool m_use_transposition_table = false;
+
+    /** Memory for the search tree and the transposition table. */
+    size_t m_memory;
+
+    bool m_use_solver = false;
+
+    /** Whether the solver is used in the current search.
+        @see set_use_solver() */
+    bool m_is_solving = false;
+
+    unsigned m_nu_thread_groups = 1;
+
+    unsigned m_thread_group_merge_interval = 64;
+
+    /** Number of thread groups used in the current search.
+        0 if the hybrid root-parallel mode is not used. */
+    unsigned m_nu_active_thread_groups = 0;
+
+    /** Visit count of the root at the start of the current search. */
+    Float m_reused_count;
+
+    /** Whether the tree was restored with load_tree() since the last
+        search. */
+    bool m_is_tree_loaded = false;
+
     /** Player to play at the root node of the search. */
     PlayerInt m_player;
 
@@ -501,6 +699,10 @@ private:
 
     atomic<bool> m_abort = false;
 
+    /** Whether the solver has proven the value of the root position in the
+        current search. */
+    atomic<bool> m_is_root_proven = false;
+
     Float m_rave_parent_max = 50000;
 
     Float m_rave_child_max = 2000;
@@ -528,8 +730,6 @@ private:
 
     vector<unique_ptr<Thread>> m_threads;
 
-    Tree m_tmp_tree;
-
 #ifdef LIBBOARDGAME_DEBUG
     AssertionHandler m_assertion_handler;
 #endif
@@ -539,6 +739,12 @@ private:
 
     ArrayList<Move, max_moves> m_followup_sequence;
 
+
+    /** Get the number of entries of the transposition table for a given
+        search memory. */
+    static size_t get_tt_size(size_t memory);
+
+
     bool check_abort(const ThreadState& thread_state) const;
 
     LIBBOARDGAME_NOINLINE
@@ -549,13 +755,28 @@ private:
     bool estimate_reused_root_val(Tree& tree, const Node& root, Float& value,
                                   Float& count);
 
+    bool evaluate_proven(ThreadState& thread_state);
+
     bool expand_node(ThreadState& thread_state, const Node& node,
                      const Node*& best_child);
 
+    void init_from_transposition_table(
+            const State& state, const typename Tree::NodeExpander& expander);
+
+    Float get_search_count() const;
+
+    Float get_wins(const Node& node) const;
+
+    void init_thread_groups(unsigned nu_threads);
+
+    void merge_thread_group(ThreadGroup& group);
+
     void playout(ThreadState& thread_state);
 
     void play_in_tree(ThreadState& thread_state);
 
+    void propagate_proven(const Simulation& simulation);
+
     bool prune(TimeSource& time_source, double time, Float prune_min_count,
                Float& new_prune_min_count);
 
@@ -564,6 +785,9 @@ private:
     const Node* select_child(const Node& node,
                              const typename Tree::Children& children);
 
+    const Node* select_root_child(ThreadGroup& group,
+                                  const typename Tree::Children& children);
+
     void update_lgr(ThreadState& thread_state);
 
     void update_rave(ThreadState& thread_state);
@@ -660,9 +884,9 @@ void SearchBase<S, M, R>::AssertionHandler::run()
 
 template<class S, class M, class R>
 SearchBase<S, M, R>::SearchBase(unsigned nu_threads, size_t memory)
-    : m_tree(memory / 2, nu_threads),
+    : m_tree(memory, nu_threads),
       m_nu_threads(nu_threads),
-      m_tmp_tree(memory / 2, m_nu_threads)
+      m_memory(memory)
 #ifdef LIBBOARDGAME_DEBUG
       , m_assertion_handler(*this)
 #endif
@@ -675,11 +899,17 @@ template<class S, class M, class R>
 bool SearchBase<S, M, R>::check_abort(
         [[maybe_unused]] const ThreadState& thread_state) const
 {
-    if (m_max_count > 0 && m_tree.get_root().get_visit_count() >= m_max_count)
+    if (m_max_count > 0 && get_search_count() >= m_max_count)
     {
         LIBBOARDGAME_LOG_THREAD(thread_state, "Maximum count reached");
         return true;
     }
+    if (SearchParamConst::use_solver
+            && m_is_root_proven.load(memory_order_relaxed))
+    {
+        LIBBOARDGAME_LOG_THREAD(thread_state, "Root position proven");
+        return true;
+    }
     return false;
 }
 
@@ -693,11 +923,11 @@ bool SearchBase<S, M, R>::check_abort_expensive(
         return true;
     }
     static_assert(numeric_limits<Float>::radix == 2);
-    auto count = m_tree.get_root().get_visit_count();
-    if (count >= (size_t(1) << numeric_limits<Float>::digits) - 1)
+    auto count = get_search_count();
+    if (count >= Float(Node::max_visit_count))
     {
         LIBBOARDGAME_LOG_THREAD(thread_state,
-                                "Max count supported by float exceeded");
+                                "Max count supported by nodes exceeded");
         return true;
     }
     auto time = m_timer();
@@ -745,7 +975,7 @@ bool SearchBase<S, M, R>::check_cannot_change(
     Float second_max = 0;
     for (auto& i : m_tree.get_root_children())
     {
-        Float wins = i.get_value() * i.get_value_count();
+        Float wins = get_wins(i);
         if (wins > max_wins)
         {
             second_max = max_wins;
@@ -831,6 +1061,9 @@ bool SearchBase<S, M, R>::expand_node(ThreadState& thread_state,
     auto root_val = m_root_val[state.get_player()].get_mean();
     if (state.gen_children(expander, root_val))
     {
+        if constexpr (SearchParamConst::use_transposition_table)
+            if (m_use_transposition_table)
+                init_from_transposition_table(state, expander);
         expander.link_children(m_tree, node);
         best_child = expander.get_best_child();
         return true;
@@ -838,6 +1071,136 @@ bool SearchBase<S, M, R>::expand_node(ThreadState& thread_state,
     return false;
 }
 
+template<class S, class M, class R>
+size_t SearchBase<S, M, R>::get_tt_size(size_t memory)
+{
+    if (! SearchParamConst::use_transposition_table)
+        return 0;
+    return TranspositionTable<Float, multithread>::get_size(
+                memory / 8, transposition_table_size);
+}
+
+template<class S, class M, class R>
+void SearchBase<S, M, R>::init_from_transposition_table(
+        const State& state, const typename Tree::NodeExpander& expander)
+{
+    // The children are not yet linked to the parent, so we can add the
+    // values without caring about other threads.
+    Float value;
+    Float count;
+    for (auto& i : expander.get_children())
+        if (m_tt->lookup(state.get_child_hash(i.get_move()), value, count))
+            m_tree.add_value(i, value, count);
+}
+
+/** Get the visit count of the root during a search.
+    In the hybrid root-parallel mode, the visit count of the root in the tree
+    does not include the simulations of the thread groups since their last
+    merge, so the count is computed from the number of simulations. */
+template<class S, class M, class R>
+inline auto SearchBase<S, M, R>::get_search_count() const -> Float
+{
+    if (m_nu_active_thread_groups > 0)
+        return m_reused_count
+                + Float(m_nu_simulations.load(memory_order_relaxed));
+    return m_tree.get_root().get_visit_count();
+}
+
+/** Get the number of wins of a child of the root used in select_final().
+    Proven wins are always preferred. For other proven nodes, the visit count
+    is used instead of the value count, which is not a real count for them
+    (see Node::proven_count). All proven wins, and all proven losses, have
+    the same number of wins; select_final() breaks such ties. */
+template<class S, class M, class R>
+auto SearchBase<S, M, R>::get_wins(const Node& node) const -> Float
+{
+    auto value = node.get_value();
+    if (! node.is_proven())
+        return value * node.get_value_count();
+    if (value >= 1)
+        return Node::proven_count;
+    return value * node.get_visit_count();
+}
+
+template<class S, class M, class R>
+void SearchBase<S, M, R>::init_thread_groups(unsigned nu_threads)
+{
+    auto nu_groups = min(m_nu_thread_groups, nu_threads);
+    if (! multithread || nu_groups <= 1)
+    {
+        m_nu_active_thread_groups = 0;
+        for (auto& i : m_threads)
+            i->thread_state.group = nullptr;
+        return;
+    }
+    m_nu_active_thread_groups = nu_groups;
+    while (m_thread_groups.size() < nu_groups)
+        m_thread_groups.push_back(make_unique<ThreadGroup>());
+    auto& root = m_tree.get_root();
+    auto children = m_tree.get_children(root);
+    auto nu_children = static_cast<unsigned>(children.size());
+    for (unsigned i = 0; i < nu_groups; ++i)
+    {
+        auto& group = *m_thread_groups[i];
+        if (group.capacity < nu_children)
+        {
+            group.children = make_unique<Node[]>(nu_children);
+            group.delta_children = make_unique<Node[]>(nu_children);
+            group.capacity = nu_children;
+        }
+        group.nu_children = nu_children;
+        group.root.restore(Move::null(), 0, 0, root.get_visit_count(), 0);
+        group.delta_root.restore(Move::null(), 0, 0, 0, 0);
+        for (unsigned j = 0; j < nu_children; ++j)
+        {
+            auto& child = children.begin()[j];
+            group.children[j].restore(
+                        child.get_move(), child.get_value(),
+                        child.get_value_count(), child.get_visit_count(),
+                        child.get_move_prior());
+            group.delta_children[j].restore(child.get_move(), 0, 0, 0, 0);
+        }
+    }
+    for (unsigned i = 0; i < m_threads.size(); ++i)
+        m_threads[i]->thread_state.group =
+                (i < nu_threads ? m_thread_groups[i % nu_groups].get()
+                                : nullptr);
+}
+
+/** Add the statistics collected by a thread group since the last merge to
+    the shared tree and update the group's copy of the root statistics with
+    the merged statistics of all groups.
+    This is called by one thread of the group while the other threads of the
+    group continue to update the statistics. Like the other parts of the
+    lock-free search, it does not care about the updates that are lost
+    because of this. */
+template<class S, class M, class R>
+void SearchBase<S, M, R>::merge_thread_group(ThreadGroup& group)
+{
+    auto& root = m_tree.get_root();
+    auto children = m_tree.get_children(root);
+    LIBBOARDGAME_ASSERT(children.size() == group.nu_children);
+    m_tree.add_visit_count(root, group.delta_root.get_visit_count());
+    group.delta_root.restore(Move::null(), 0, 0, 0, 0);
+    group.root.restore(Move::null(), 0, 0, root.get_visit_count(), 0);
+    for (unsigned i = 0; i < group.nu_children; ++i)
+    {
+        auto& child = children.begin()[i];
+        auto& delta = group.delta_children[i];
+        auto count = delta.get_value_count();
+        if (count > 0)
+            m_tree.add_value(child, delta.get_value(), count);
+        auto visit_count = delta.get_visit_count();
+        if (visit_count > 0)
+            m_tree.add_visit_count(child, visit_count);
+        delta.restore(child.get_move(), 0, 0, 0, 0);
+        group.children[i].restore(child.get_move(), child.get_value(),
+                                  child.get_value_count(),
+                                  child.get_visit_count(),
+                                  child.get_move_prior());
+    }
+}
+
 template<class S, class M, class R>
 inline size_t SearchBase<S, M, R>::get_nu_simulations() const
 {
@@ -883,6 +1246,12 @@ inline auto SearchBase<S, M, R>::get_rave_weight() const -> Float
     return m_rave_weight;
 }
 
+template<class S, class M, class R>
+inline unsigned SearchBase<S, M, R>::get_nu_thread_groups() const
+{
+    return m_nu_thread_groups;
+}
+
 template<class S, class M, class R>
 inline bool SearchBase<S, M, R>::get_reuse_subtree() const
 {
@@ -895,6 +1264,18 @@ inline bool SearchBase<S, M, R>::get_reuse_tree() const
     return m_reuse_tree;
 }
 
+template<class S, class M, class R>
+inline bool SearchBase<S, M, R>::get_use_solver() const
+{
+    return m_use_solver;
+}
+
+template<class S, class M, class R>
+inline bool SearchBase<S, M, R>::get_use_transposition_table() const
+{
+    return m_use_transposition_table;
+}
+
 template<class S, class M, class R>
 inline S& SearchBase<S, M, R>::get_state(unsigned thread_id)
 {
@@ -909,12 +1290,31 @@ inline const S& SearchBase<S, M, R>::get_state(unsigned thread_id) const
     return *m_threads[thread_id]->thread_state.state;
 }
 
+template<class S, class M, class R>
+inline unsigned SearchBase<S, M, R>::get_thread_group_merge_interval() const
+{
+    return m_thread_group_merge_interval;
+}
+
 template<class S, class M, class R>
 inline auto SearchBase<S, M, R>::get_tree() const -> const Tree&
 {
     return m_tree;
 }
 
+template<class S, class M, class R>
+bool SearchBase<S, M, R>::is_same_side(PlayerInt player1,
+                                       PlayerInt player2) const
+{
+    return player1 == player2;
+}
+
+template<class S, class M, class R>
+bool SearchBase<S, M, R>::is_solver_supported() const
+{
+    return get_nu_players() == 2;
+}
+
 template<class S, class M, class R>
 void SearchBase<S, M, R>::on_start_search([[maybe_unused]] bool is_followup)
 {
@@ -926,19 +1326,7 @@ void SearchBase<S, M, R>::playout(ThreadState& thread_state)
 {
     auto& state = *thread_state.state;
     state.start_playout();
-    auto& simulation = thread_state.simulation;
-    auto& moves = simulation.moves;
-    auto nu_moves = moves.size();
-    Move last = nu_moves > 0 ? moves[nu_moves - 1].move : Move::null();
-    Move second_last = nu_moves > 1 ? moves[nu_moves - 2].move : Move::null();
-    PlayerMove mv;
-    while (state.gen_playout_move(m_lgr, last, second_last, mv))
-    {
-        state.play_playout(mv.move);
-        moves.push_back(mv);
-        second_last = last;
-        last = mv.move;
-    }
+    state.playout(m_lgr, thread_state.simulation.moves);
 }
 
 template<class S, class M, class R>
@@ -948,20 +1336,43 @@ void SearchBase<S, M, R>::play_in_tree(ThreadState& thread_state)
     auto& simulation = thread_state.simulation;
     simulation.nodes.resize(1);
     simulation.moves.clear();
+    bool use_tt =
+            SearchParamConst::use_transposition_table
+            && m_use_transposition_table;
+    if (use_tt)
+        simulation.hashes.resize(1);
+    bool is_solving = SearchParamConst::use_solver && m_is_solving;
+    simulation.solvable_begin = 0;
     auto& root = m_tree.get_root();
     auto node = &root;
     Float expansion_threshold = SearchParamConst::expansion_threshold;
     typename Tree::Children children;
     while (! (children = m_tree.get_children(*node)).empty())
     {
-        node = select_child(*node, children);
-        if (multithread && SearchParamConst::virtual_loss)
-            m_tree.add_value(*node, 0);
+        if constexpr (SearchParamConst::use_solver)
+            if (is_solving && ! state.has_complete_children())
+                simulation.solvable_begin =
+                        static_cast<unsigned>(simulation.nodes.size());
+        if (node == &root && thread_state.group)
+            node = select_root_child(*thread_state.group, children);
+        else
+        {
+            node = select_child(*node, children);
+            if (multithread && SearchParamConst::virtual_loss)
+                m_tree.add_value(*node, 0);
+        }
         simulation.nodes.push_back(node);
         Move mv = node->get_move();
         simulation.moves.push_back({state.get_player(), mv});
         state.play_in_tree(mv);
+        if constexpr (SearchParamConst::use_transposition_table)
+            if (use_tt)
+                simulation.hashes.push_back(state.get_hash());
         expansion_threshold += SearchParamConst::expansion_threshold_inc;
+        if (is_solving && node->is_proven())
+            // No need to search the subtree, evaluate_proven() uses the
+            // proven value
+            break;
     }
     state.finish_in_tree();
     if (node->get_visit_count() > expansion_threshold && node->is_unexpanded())
@@ -975,6 +1386,9 @@ void SearchBase<S, M, R>::play_in_tree(ThreadState& thread_state)
             Move mv = node->get_move();
             simulation.moves.push_back({state.get_player(), mv});
             state.play_expanded_child(mv);
+            if constexpr (SearchParamConst::use_transposition_table)
+                if (use_tt)
+                    simulation.hashes.push_back(state.get_hash());
         }
     }
     thread_state.stat_in_tree_len.add(double(simulation.moves.size()));
@@ -1013,20 +1427,81 @@ string SearchBase<S, M, R>::get_info_ext() const
     return {};
 }
 
+template<class S, class M, class R>
+template<class F>
+void SearchBase<S, M, R>::load_tree(const char*& data, const char* end,
+                                    F is_valid_move)
+{
+    uint8_t float_size;
+    uint8_t compact_node;
+    read_binary(data, end, float_size);
+    read_binary(data, end, compact_node);
+    if (float_size != sizeof(Float)
+            || compact_node != SearchParamConst::compact_node)
+        throw runtime_error("search tree data has a different node layout");
+    for (auto& root_val : m_root_val)
+    {
+        Float mean, count;
+        read_binary(data, end, mean);
+        read_binary(data, end, count);
+        root_val.init(mean, count);
+    }
+    m_tree.load(data, end, is_valid_move);
+    m_is_tree_loaded = true;
+}
+
+/** Propagate proven values from the last node of a simulation to its
+    ancestors.
+    A node is proven if one of its children is a proven win for the player to
+    play at the node or if all of its children are proven. */
+template<class S, class M, class R>
+void SearchBase<S, M, R>::propagate_proven(const Simulation& simulation)
+{
+    auto& nodes = simulation.nodes;
+    auto& moves = simulation.moves;
+    for (auto i = nodes.size() - 1; i-- > simulation.solvable_begin; )
+    {
+        auto children = m_tree.get_children(*nodes[i]);
+        if (children.empty())
+            // Node is being expanded again by another thread
+            return;
+        Float max_value = -1;
+        bool is_complete = true;
+        for (auto& child : children)
+            if (! child.is_proven())
+                is_complete = false;
+            else if (child.get_value() > max_value)
+            {
+                max_value = child.get_value();
+                if (max_value >= 1)
+                    break;
+            }
+        if (max_value < 1 && ! is_complete)
+            return;
+        if (i == 0)
+        {
+            m_is_root_proven.store(true, memory_order_relaxed);
+            return;
+        }
+        auto player = moves[i].player;
+        if (! is_same_side(moves[i - 1].player, player))
+            max_value = 1 - max_value;
+        m_tree.set_proven(*nodes[i], max_value);
+    }
+}
+
 template<class S, class M, class R>
 bool SearchBase<S, M, R>::prune(
         TimeSource& time_source, [[maybe_unused]] double time,
         Float prune_min_count, Float& new_prune_min_count)
 {
     Timer timer(time_source);
-    m_tmp_tree.clear();
-    m_tree.copy_subtree(m_tmp_tree, m_tmp_tree.get_root(), m_tree.get_root(),
-                        prune_min_count);
-    auto percent = int(m_tmp_tree.get_nu_nodes() * 100 / m_tree.get_nu_nodes());
+    auto nu_nodes = m_tree.get_nu_nodes();
+    m_tree.prune(prune_min_count);
+    auto percent = int(m_tree.get_nu_nodes() * 100 / nu_nodes);
     LIBBOARDGAME_LOG("Pruning MinCnt: ", prune_min_count, ", AtTm: ", time,
-                     ", Nds: ", m_tmp_tree.get_nu_nodes(), " (", percent,
+                     ", Nds: ", m_tree.get_nu_nodes(), " (", percent,
                      "%), Tm: ", timer());
-    m_tree.swap(m_tmp_tree);
     if (percent > 50)
     {
         if (prune_min_count >= 0.5f * numeric_limits<Float>::max())
@@ -1059,9 +1534,58 @@ bool SearchBase<S, M, R>::estimate_reused_root_val(Tree& tree,
         return false;
     value = best->get_value();
     count = best->get_value_count();
+    if (best->is_proven())
+        // The value count of proven nodes is not a real count
+        count = best->get_visit_count();
     return count > 0;
 }
 
+/** Evaluate a simulation that ended in a proven or terminal node.
+    Terminal nodes are marked as proven with the exact game result and the
+    proven values are propagated to the ancestors of the node.
+    @return @c false if the simulation did not end in a proven or terminal
+    node and needs a playout. */
+template<class S, class M, class R>
+bool SearchBase<S, M, R>::evaluate_proven(ThreadState& thread_state)
+{
+    auto& state = *thread_state.state;
+    auto& simulation = thread_state.simulation;
+    auto& eval = simulation.eval;
+    auto nu_moves = simulation.moves.size();
+    if (nu_moves == 0)
+        return false;
+    auto& node = *simulation.nodes[nu_moves];
+    auto player = simulation.moves[nu_moves - 1].player;
+    if (node.is_proven())
+    {
+        auto value = node.get_value();
+        for (PlayerInt i = 0; i < m_nu_players; ++i)
+            eval[i] = (is_same_side(i, player) ? value : 1 - value);
+    }
+    else if (node.get_nu_children() == 0)
+    {
+        state.evaluate_terminal(eval);
+        m_tree.set_proven(node, eval[player]);
+    }
+    else
+        return false;
+    propagate_proven(simulation);
+    return true;
+}
+
+template<class S, class M, class R>
+void SearchBase<S, M, R>::save_tree(ostream& out) const
+{
+    write_binary(out, static_cast<uint8_t>(sizeof(Float)));
+    write_binary(out, static_cast<uint8_t>(SearchParamConst::compact_node));
+    for (auto& root_val : m_root_val)
+    {
+        write_binary(out, root_val.get_mean());
+        write_binary(out, root_val.get_count());
+    }
+    m_tree.save(out);
+}
+
 template<class S, class M, class R>
 bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
                                  size_t min_simulations, double max_time,
@@ -1071,7 +1595,11 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
         create_threads();
     m_deterministic = RandomGenerator::has_global_seed();
     bool is_followup = check_followup(m_followup_sequence);
-    on_start_search(is_followup);
+    // Caches of the last search (in this class and in the subclass) are not
+    // valid for a tree restored with load_tree(), only the tree can be reused
+    bool is_tree_loaded = m_is_tree_loaded;
+    m_is_tree_loaded = false;
+    on_start_search(is_followup && ! is_tree_loaded);
     if (max_count > 0)
         // A fixed number of simulations means that no time limit is used, but
         // max_time is still used at some places in the code, so we set it to
@@ -1079,6 +1607,8 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
         max_time = numeric_limits<double>::max();
     m_player = get_player();
     m_nu_players = get_nu_players();
+    m_is_solving = m_use_solver && is_solver_supported();
+    m_is_root_proven = false;
     bool clear_tree = true;
     bool is_same = false;
     if (is_followup && m_followup_sequence.empty())
@@ -1097,41 +1627,41 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
         for (PlayerInt i = 0; i < m_nu_players; ++i)
             m_root_val[i].init(SearchParamConst::tie_value, 1);
     if ((m_reuse_subtree && (is_followup || m_abort))
-            || (m_reuse_tree && is_same))
+            || ((m_reuse_tree || is_tree_loaded) && is_same))
     {
         size_t tree_nodes = m_tree.get_nu_nodes();
         if (m_followup_sequence.empty())
         {
             if (tree_nodes > 1)
+            {
                 LIBBOARDGAME_LOG("Reusing all ", tree_nodes, " nodes (count=",
                                  m_tree.get_root().get_visit_count(), ")");
+                clear_tree = false;
+            }
         }
         else
         {
             Timer timer(time_source);
-            m_tmp_tree.clear();
             auto node = find_node(m_tree, m_followup_sequence);
             if (node)
             {
-                m_tree.extract_subtree(m_tmp_tree, *node);
-                auto& tmp_tree_root = m_tmp_tree.get_root();
+                m_tree.keep_subtree(*node);
                 if (! is_same)
                 {
                     Float value, count;
-                    if (estimate_reused_root_val(m_tmp_tree, tmp_tree_root,
+                    if (estimate_reused_root_val(m_tree, m_tree.get_root(),
                                                  value, count))
                         m_root_val[m_player].add(value, count);
                 }
-                size_t tmp_tree_nodes = m_tmp_tree.get_nu_nodes();
-                if (tree_nodes > 1 && tmp_tree_nodes > 1)
+                size_t new_tree_nodes = m_tree.get_nu_nodes();
+                if (tree_nodes > 1 && new_tree_nodes > 1)
                 {
                     double time = timer();
-                    LIBBOARDGAME_LOG("Reusing ", tmp_tree_nodes, " nodes (",
+                    LIBBOARDGAME_LOG("Reusing ", new_tree_nodes, " nodes (",
                                      std::fixed, setprecision(1),
-                                     100 * double(tmp_tree_nodes)
+                                     100 * double(new_tree_nodes)
                                      / double(tree_nodes),
                                      "% tm=", setprecision(4), time, ")");
-                    m_tree.swap(m_tmp_tree);
                     clear_tree = false;
                     max_time -= time;
                     if (max_time < 0)
@@ -1146,8 +1676,12 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
     m_timer.reset(time_source);
     m_time_source = &time_source;
     m_abort = false;
-    if (SearchParamConst::use_lgr && ! is_followup)
+    if (SearchParamConst::use_lgr && (! is_followup || is_tree_loaded))
         m_lgr.init(m_nu_players);
+    if (SearchParamConst::use_transposition_table
+            && m_use_transposition_table
+            && ((! is_followup && ! is_same) || is_tree_loaded))
+        m_tt->clear();
     for (auto& i : m_threads)
     {
         auto& thread_state = i->thread_state;
@@ -1163,6 +1697,7 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
 
     // Don't use multi-threading for very short searches (less than 0.5s).
     auto reused_count = m_tree.get_root().get_visit_count();
+    m_reused_count = reused_count;
     unsigned nu_threads = m_nu_threads;
     double expected_time;
     if (max_count > 0)
@@ -1195,11 +1730,14 @@ bool SearchBase<S, M, R>::search(Move& mv, Float max_count,
     else
         while (true)
         {
+            init_thread_groups(nu_threads);
             for (unsigned i = 1; i < nu_threads; ++i)
                 m_threads[i]->start_search();
             search_loop(thread_state_0);
             for (unsigned i = 1; i < nu_threads; ++i)
                 m_threads[i]->wait_search_finished();
+            for (unsigned i = 0; i < m_nu_active_thread_groups; ++i)
+                merge_thread_group(*m_thread_groups[i]);
             bool is_out_of_mem = false;
             for (unsigned i = 0; i < nu_threads; ++i)
                 if (m_threads[i]->thread_state.is_out_of_mem)
@@ -1241,6 +1779,12 @@ void SearchBase<S, M, R>::search_loop(ThreadState& thread_state)
                     max(1.0, SearchParamConst::expected_sim_per_sec / 5.0));
         expensive_abort_checker.set_deterministic(interval);
     }
+    // In hybrid root-parallel mode, the thread with the same index as its
+    // group merges the statistics of the group
+    bool is_group_merger =
+            thread_state.group
+            && thread_state.thread_id < m_nu_active_thread_groups;
+    unsigned merge_countdown = m_thread_group_merge_interval;
     while (true)
     {
         thread_state.is_out_of_mem = false;
@@ -1251,14 +1795,26 @@ void SearchBase<S, M, R>::search_loop(ThreadState& thread_state)
         play_in_tree(thread_state);
         if (thread_state.is_out_of_mem)
             break;
-        playout(thread_state);
-        state.evaluate_playout(simulation.eval);
+        bool is_proven = false;
+        if constexpr (SearchParamConst::use_solver)
+            if (m_is_solving)
+                is_proven = evaluate_proven(thread_state);
+        if (! is_proven)
+        {
+            playout(thread_state);
+            state.evaluate_playout(simulation.eval);
+        }
         thread_state.stat_len.add(double(simulation.moves.size()));
         update_values(thread_state);
         if (SearchParamConst::rave)
             update_rave(thread_state);
         if (SearchParamConst::use_lgr)
             update_lgr(thread_state);
+        if (is_group_merger && --merge_countdown == 0)
+        {
+            merge_thread_group(*thread_state.group);
+            merge_countdown = m_thread_group_merge_interval;
+        }
     }
 }
 
@@ -1280,50 +1836,63 @@ inline auto SearchBase<S, M, R>::select_child(
             m_exploration_constant * sqrt(parent_count)
             * log(parent_count + 1);
     static_assert(SearchParamConst::child_min_count > 0);
-    auto expl_limit =
-            expl_factor * SearchParamConst::max_move_prior
-            / SearchParamConst::child_min_count;
-    auto i = children.begin();
-    auto value =
-            i->get_value()
-            + i->get_move_prior() * expl_factor / i->get_value_count();
-    auto best_value = value;
-    auto limit = best_value - expl_limit;
-    auto best_child = i;
-    while (++i != children.end())
+    if constexpr (SearchParamConst::select_child_block_size > 0)
+        return select_child_blocked<SearchParamConst::select_child_block_size>(
+                    children, expl_factor);
+    else
     {
-        value = i->get_value();
-        if (value <= limit)
-            continue;
-        value += i->get_move_prior() * expl_factor / i->get_value_count();
-        if (value > best_value)
-        {
-            best_value = value;
-            limit = best_value - expl_limit;
-            best_child = i;
-        }
+        auto expl_limit =
+                expl_factor * SearchParamConst::max_move_prior
+                / SearchParamConst::child_min_count;
+        return select_child_scalar(children, expl_factor, expl_limit);
     }
-    return best_child;
+}
+
+/** Select child of the root using the statistics of a thread group.
+    Returns the child in the shared tree.
+    @see set_nu_thread_groups() */
+template<class S, class M, class R>
+inline auto SearchBase<S, M, R>::select_root_child(
+        ThreadGroup& group,
+        const typename Tree::Children& children) -> const Node*
+{
+    LIBBOARDGAME_ASSERT(children.size() == group.nu_children);
+    auto begin = group.children.get();
+    typename Tree::Children group_children(begin, begin + group.nu_children);
+    auto i = select_child(group.root, group_children) - begin;
+    if (multithread && SearchParamConst::virtual_loss)
+        group.children[i].add_value(0);
+    return children.begin() + i;
 }
 
 template<class S, class M, class R>
 auto SearchBase<S, M, R>::select_final() const-> const Node*
 {
-    // Select the child with the highest number of wins
+    // Select the child with the highest number of wins. Ties (e.g. several
+    // proven wins, or only proven losses if the root is a proven loss) are
+    // broken by the visit count, then by the value.
     auto children = m_tree.get_children(m_tree.get_root());
     if (children.empty())
         return nullptr;
     auto i = children.begin();
     auto best_child = i;
-    auto max_wins = i->get_value_count() * i->get_value();
+    auto max_wins = get_wins(*i);
     while (++i != children.end())
     {
-        auto wins = i->get_value_count() * i->get_value();
-        if (wins > max_wins)
+        auto wins = get_wins(*i);
+        if (wins < max_wins)
+            continue;
+        if (wins == max_wins)
         {
-            max_wins = wins;
-            best_child = i;
+            auto count = i->get_visit_count();
+            auto max_count = best_child->get_visit_count();
+            if (count < max_count
+                    || (count == max_count
+                        && i->get_value() <= best_child->get_value()))
+                continue;
         }
+        max_wins = wins;
+        best_child = i;
     }
     return best_child;
 }
@@ -1365,6 +1934,13 @@ void SearchBase<S, M, R>::set_rave_weight(Float v)
     m_rave_weight = v;
 }
 
+template<class S, class M, class R>
+void SearchBase<S, M, R>::set_nu_thread_groups(unsigned n)
+{
+    LIBBOARDGAME_ASSERT(n > 0);
+    m_nu_thread_groups = n;
+}
+
 template<class S, class M, class R>
 void SearchBase<S, M, R>::set_reuse_subtree(bool enable)
 {
@@ -1377,6 +1953,47 @@ void SearchBase<S, M, R>::set_reuse_tree(bool enable)
     m_reuse_tree = enable;
 }
 
+template<class S, class M, class R>
+void SearchBase<S, M, R>::set_thread_group_merge_interval(unsigned n)
+{
+    LIBBOARDGAME_ASSERT(n > 0);
+    m_thread_group_merge_interval = n;
+}
+
+template<class S, class M, class R>
+void SearchBase<S, M, R>::set_use_solver(bool enable)
+{
+    if (enable && ! SearchParamConst::use_solver)
+        throw runtime_error("libboardgame_mcts::Search was compiled"
+                            " without support for solver");
+    m_use_solver = enable;
+}
+
+template<class S, class M, class R>
+void SearchBase<S, M, R>::set_use_transposition_table(bool enable)
+{
+    if (enable && ! SearchParamConst::use_transposition_table)
+        throw runtime_error("libboardgame_mcts::Search was compiled"
+                            " without support for transposition table");
+    if (enable == m_use_transposition_table)
+        return;
+    using TT = TranspositionTable<Float, multithread>;
+    if (enable)
+    {
+        auto tt_size = get_tt_size(m_memory);
+        if (tt_size == 0)
+            throw runtime_error("not enough memory for transposition table");
+        m_tree.set_memory(m_memory - TT::get_memory(tt_size));
+        m_tt = make_unique<TT>(tt_size);
+    }
+    else
+    {
+        m_tt.reset();
+        m_tree.set_memory(m_memory);
+    }
+    m_use_transposition_table = enable;
+}
+
 template<class S, class M, class R>
 void SearchBase<S, M, R>::update_lgr(ThreadState& thread_state)
 {
@@ -1449,7 +2066,9 @@ void SearchBase<S, M, R>::update_rave(ThreadState& thread_state)
         Float dist_factor;
         if (SearchParamConst::rave_dist_weighting)
             dist_factor = 1 / static_cast<Float>(nu_moves - i);
-        for (auto& it : m_tree.get_children(*node))
+        auto children = m_tree.get_children(*node);
+        auto group = (i == 0 ? thread_state.group : nullptr);
+        for (auto& it : children)
         {
             auto mv = it.get_move();
             if (was_played[mv.to_int()] != player
@@ -1460,7 +2079,15 @@ void SearchBase<S, M, R>::update_rave(ThreadState& thread_state)
             Float weight = m_rave_weight;
             if (SearchParamConst::rave_dist_weighting)
                 weight *= 1 - static_cast<Float>(first - i) * dist_factor;
-            m_tree.add_value(it, thread_state.simulation.eval[player], weight);
+            auto v = thread_state.simulation.eval[player];
+            if (group)
+            {
+                auto j = &it - children.begin();
+                group->children[j].add_value(v, weight);
+                group->delta_children[j].add_value(v, weight);
+            }
+            else
+                m_tree.add_value(it, v, weight);
         }
         if (i == 0)
             break;
@@ -1484,23 +2111,51 @@ void SearchBase<S, M, R>::update_values(ThreadState& thread_state)
     auto& nodes = simulation.nodes;
     auto& eval = simulation.eval;
     auto nu_nodes = static_cast<unsigned>(nodes.size());
-    m_tree.inc_visit_count(*nodes[0]);
+    bool use_tt =
+            SearchParamConst::use_transposition_table
+            && m_use_transposition_table;
+    auto group = thread_state.group;
+    if (group)
+    {
+        group->root.inc_visit_count();
+        group->delta_root.inc_visit_count();
+    }
+    else
+        m_tree.inc_visit_count(*nodes[0]);
     for (unsigned i = 1; i < nu_nodes; ++i)
     {
         auto& node = *nodes[i];
         auto mv = simulation.moves[i - 1];
-        if (multithread && SearchParamConst::virtual_loss)
-            // Note that this could become problematic if the number of threads
-            // is large. The lock-free algorithm intentionally ignores lost or
-            // partial updates to run faster. But the probability that adding
-            // a virtual loss is lost is not the same as that its removal is
-            // lost because the removal is done in this function with many
-            // calls to add_value() but the adding is done in play_in_tree().
-            // This could introduce a systematic error.
-            m_tree.add_value_remove_loss(node, eval[mv.player]);
+        if (i == 1 && group)
+        {
+            auto j = &node - m_tree.get_children(*nodes[0]).begin();
+            auto& group_node = group->children[j];
+            if (multithread && SearchParamConst::virtual_loss)
+                group_node.add_value_remove_loss(eval[mv.player]);
+            else
+                group_node.add_value(eval[mv.player]);
+            group_node.inc_visit_count();
+            group->delta_children[j].add_value(eval[mv.player]);
+            group->delta_children[j].inc_visit_count();
+        }
         else
-            m_tree.add_value(node, eval[mv.player]);
-        m_tree.inc_visit_count(node);
+        {
+            if (multithread && SearchParamConst::virtual_loss)
+                // Note that this could become problematic if the number of
+                // threads is large. The lock-free algorithm intentionally
+                // ignores lost or partial updates to run faster. But the
+                // probability that adding a virtual loss is lost is not the
+                // same as that its removal is lost because the removal is done
+                // in this function with many calls to add_value() but the
+                // adding is done in play_in_tree(). This could introduce a
+                // systematic error.
+                m_tree.add_value_remove_loss(node, eval[mv.player]);
+            else
+                m_tree.add_value(node, eval[mv.player]);
+            m_tree.inc_visit_count(node);
+        }
+        if (use_tt)
+            m_tt->add_value(simulation.hashes[i], eval[mv.player]);
     }
     for (PlayerInt i = 0; i < m_nu_players; ++i)
         m_root_val[i].add(eval[i]);
@@ -0,0 +1,130 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_mcts/SelectChild.h
+    Functions for finding the child with the highest selection value in the
+    in-tree phase of the search.
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_MCTS_SELECT_CHILD_H
+#define LIBBOARDGAME_MCTS_SELECT_CHILD_H
+
+#include <algorithm>
+#include <limits>
+#include "libboardgame_base/Range.h"
+
+namespace libboardgame_mcts {
+
+using namespace std;
+using libboardgame_base::Range;
+
+//-----------------------------------------------------------------------------
+
+/** Find the child with the highest value plus exploration term.
+    Handles one child at a time and skips the computation of the exploration
+    term for children with a value so low that they cannot become the best
+    child even with the maximum exploration term.
+    @param children The children.
+    @param expl_factor The exploration term without the move prior and child
+    count (see description of class SearchBase).
+    @param expl_limit Upper limit for the exploration term of all children.
+    @return The first child with the highest selection value.
+    @pre ! children.empty() */
+template<class N>
+const N* select_child_scalar(const Range<const N>& children,
+                             typename N::Float expl_factor,
+                             typename N::Float expl_limit)
+{
+    auto i = children.begin();
+    auto value =
+            i->get_value()
+            + i->get_move_prior() * expl_factor / i->get_value_count();
+    auto best_value = value;
+    auto limit = best_value - expl_limit;
+    auto best_child = i;
+    while (++i != children.end())
+    {
+        value = i->get_value();
+        if (value <= limit)
+            continue;
+        value += i->get_move_prior() * expl_factor / i->get_value_count();
+        if (value > best_value)
+        {
+            best_value = value;
+            limit = best_value - expl_limit;
+            best_child = i;
+        }
+    }
+    return best_child;
+}
+
+/** Find the child with the highest value plus exploration term in blocks
+    of W children.
+    The node data of a block is first copied into local arrays (the nodes
+    are stored as an array of structures and their members are atomic, which
+    prevents the compiler from vectorizing the computation on the nodes
+    directly). The computation of the selection values and the maximum on
+    the local arrays has no dependencies between the elements and can be
+    vectorized by the compiler. Only the block that contains a new maximum
+    is searched for the index of the child. W should be the number of
+    elements of type N::Float that fit into the widest vector register of the
+    target architecture (e.g. 8 for float with AVX2, 16 with AVX-512). Also
+    works but is slower than select_child_scalar() if the compiler does not
+    vectorize the code.
+    @return The first child with the highest selection value, same as
+    select_child_scalar().
+    @pre ! children.empty() */
+template<unsigned W, class N>
+const N* select_child_blocked(const Range<const N>& children,
+                              typename N::Float expl_factor)
+{
+    static_assert(W > 0);
+    using Float = typename N::Float;
+    alignas(64) Float value[W];
+    alignas(64) Float move_prior[W];
+    alignas(64) Float value_count[W];
+    alignas(64) Float selection_value[W];
+    auto best_child = children.begin();
+    auto best_value = -numeric_limits<Float>::max();
+    auto nu_children = children.size();
+    for (size_t begin = 0; begin < nu_children; begin += W)
+    {
+        auto block = children.begin() + begin;
+        auto n = static_cast<unsigned>(min(size_t(W), nu_children - begin));
+        for (unsigned i = 0; i < n; ++i)
+        {
+            value[i] = block[i].get_value();
+            move_prior[i] = block[i].get_move_prior();
+            value_count[i] = block[i].get_value_count();
+        }
+        for (unsigned i = n; i < W; ++i)
+        {
+            value[i] = -numeric_limits<Float>::max();
+            move_prior[i] = 0;
+            value_count[i] = 1;
+        }
+        for (unsigned i = 0; i < W; ++i)
+            selection_value[i] =
+                    value[i] + move_prior[i] * expl_factor / value_count[i];
+        auto max_value = selection_value[0];
+        for (unsigned i = 1; i < W; ++i)
+            max_value = max(max_value, selection_value[i]);
+        if (max_value > best_value)
+        {
+            best_value = max_value;
+            for (unsigned i = 0; i < n; ++i)
+                if (selection_value[i] == max_value)
+                {
+                    best_child = block + i;
+                    break;
+                }
+        }
+    }
+    return best_child;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_mcts
+
+#endif // LIBBOARDGAME_MCTS_SELECT_CHILD_H
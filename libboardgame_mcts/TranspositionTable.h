@@ -0,0 +1,179 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_mcts/TranspositionTable.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBBOARDGAME_MCTS_TRANSPOSITION_TABLE_H
+#define LIBBOARDGAME_MCTS_TRANSPOSITION_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "Atomic.h"
+#include "libboardgame_base/Assert.h"
+
+namespace libboardgame_mcts {
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+/** Hash key of a position used in the transposition table. */
+using HashKey = uint_least64_t;
+
+//-----------------------------------------------------------------------------
+
+/** Statistics of positions that are shared between nodes of the search tree.
+    In games in which the same position can be reached by different move
+    orders, the search tree contains separate nodes for each transposition.
+    This table stores the mean value and count of all simulations that went
+    through a position (identified by a hash key provided by the game state),
+    so that a new node can be initialized with the statistics that were
+    already collected in the other transpositions of its position.
+    The table is used in the lock-free search in the same way as the nodes,
+    it intentionally does not use synchronization and does not care about
+    lost updates or the rare case that a reader sees a value and count
+    from different updates. Entries are replaced unconditionally if an update
+    for a different hash key maps to the same entry.
+    @tparam F The floating type used for values and counts.
+    @tparam MT Whether the table is used in a multi-threaded search. */
+template<typename F, bool MT>
+class TranspositionTable
+{
+public:
+    using Float = F;
+
+
+    /** Get the memory used by a table with a given number of entries. */
+    static size_t get_memory(size_t size);
+
+    /** Get the largest number of entries that is a power of 2, not greater
+        than max_size and fits into a given amount of memory.
+        Returns 0 if not even one entry fits. */
+    static size_t get_size(size_t memory, size_t max_size);
+
+
+    /** Constructor.
+        @param size The number of entries. Must be a power of 2. */
+    explicit TranspositionTable(size_t size);
+
+    void clear();
+
+    /** Get the value and count of a position.
+        @return @c false if the table has no entry for the position. */
+    bool lookup(HashKey hash, Float& value, Float& count) const;
+
+    /** Add the result of a simulation that went through a position. */
+    void add_value(HashKey hash, Float v);
+
+private:
+    struct Entry
+    {
+        Atomic<HashKey, MT> hash;
+
+        Atomic<Float, MT> value;
+
+        Atomic<Float, MT> count;
+    };
+
+
+    size_t m_mask;
+
+    unique_ptr<Entry[]> m_entries;
+
+
+    const Entry& get_entry(HashKey hash) const;
+
+    Entry& get_entry(HashKey hash);
+};
+
+template<typename F, bool MT>
+TranspositionTable<F, MT>::TranspositionTable(size_t size)
+    : m_mask(size - 1),
+      m_entries(new Entry[size])
+{
+    LIBBOARDGAME_ASSERT(size > 0 && (size & (size - 1)) == 0);
+    clear();
+}
+
+template<typename F, bool MT>
+void TranspositionTable<F, MT>::add_value(HashKey hash, Float v)
+{
+    auto& entry = get_entry(hash);
+    if (entry.hash.load(memory_order_relaxed) != hash)
+    {
+        entry.value.store(v, memory_order_relaxed);
+        entry.count.store(1, memory_order_relaxed);
+        entry.hash.store(hash, memory_order_relaxed);
+        return;
+    }
+    Float count = entry.count.load(memory_order_relaxed);
+    Float value = entry.value.load(memory_order_relaxed);
+    ++count;
+    value += (v - value) / count;
+    entry.value.store(value, memory_order_relaxed);
+    entry.count.store(count, memory_order_relaxed);
+}
+
+template<typename F, bool MT>
+void TranspositionTable<F, MT>::clear()
+{
+    // Hash key 0 is reserved for empty entries. The probability that a real
+    // position has this key is negligible and would only cause a missing
+    // entry.
+    for (size_t i = 0; i <= m_mask; ++i)
+    {
+        auto& entry = m_entries[i];
+        entry.hash.store(0, memory_order_relaxed);
+        entry.count.store(0, memory_order_relaxed);
+    }
+}
+
+template<typename F, bool MT>
+inline auto TranspositionTable<F, MT>::get_entry(HashKey hash) const
+-> const Entry&
+{
+    return m_entries[hash & m_mask];
+}
+
+template<typename F, bool MT>
+inline auto TranspositionTable<F, MT>::get_entry(HashKey hash) -> Entry&
+{
+    return m_entries[hash & m_mask];
+}
+
+template<typename F, bool MT>
+size_t TranspositionTable<F, MT>::get_memory(size_t size)
+{
+    return size * sizeof(Entry);
+}
+
+template<typename F, bool MT>
+size_t TranspositionTable<F, MT>::get_size(size_t memory, size_t max_size)
+{
+    size_t size = 0;
+    for (size_t n = 1; n <= max_size && get_memory(n) <= memory; n *= 2)
+        size = n;
+    return size;
+}
+
+template<typename F, bool MT>
+inline bool TranspositionTable<F, MT>::lookup(HashKey hash, Float& value,
+                                                 Float& count) const
+{
+    if (hash == 0)
+        return false;
+    auto& entry = get_entry(hash);
+    if (entry.hash.load(memory_order_relaxed) != hash)
+        return false;
+    count = entry.count.load(memory_order_relaxed);
+    value = entry.value.load(memory_order_relaxed);
+    return count > 0;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libboardgame_mcts
+
+#endif // LIBBOARDGAME_MCTS_TRANSPOSITION_TABLE_H
@@ -8,13 +8,20 @@
 #define LIBBOARDGAME_MCTS_TREE_H
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <vector>
 #include "Node.h"
+#include "libboardgame_base/BinaryIO.h"
+#include "libboardgame_base/Range.h"
 
 namespace libboardgame_mcts {
 
 using namespace std;
 using libboardgame_base::Range;
+using libboardgame_base::read_binary;
+using libboardgame_base::write_binary;
 
 //-----------------------------------------------------------------------------
 
@@ -22,10 +29,19 @@ using libboardgame_base::Range;
     The nodes can be modified only through member functions of this class,
     so that it can guarantee an intact tree structure. The user has access to
     all nodes, but only as const references.<p>
-    The tree uses separate parts of the node storage for different threads,
-    so it can be used without locking in multi-threaded search. Not all
-    functions are thread-safe, only the ones that are used during a search
-    (e.g. expanding a node is thread-safe, but clear() is not) */
+    The node storage is divided into chunks. Each thread creates new nodes
+    only in the chunk it currently owns, so the tree can be used without
+    locking in multi-threaded search. If the chunk of a thread is full, the
+    thread takes a new chunk from a lock-free pool shared by all threads, so
+    that the whole node storage can be used even if some threads expand more
+    nodes than others. A thread prefers chunks that it used before (after
+    clear()), then chunks that were not used yet, and only takes chunks used
+    before by other threads if no other chunks are left. Because the memory
+    of a chunk is first written by the thread that takes it, this keeps the
+    nodes of a thread on the memory of its own NUMA node if the operating
+    system uses a first-touch allocation policy (the default on Linux).<p>
+    Not all functions are thread-safe, only the ones that are used during a
+    search (e.g. expanding a node is thread-safe, but clear() is not) */
 template<typename N>
 class Tree
 {
@@ -65,8 +81,11 @@ public:
                      Float max_move_prior);
 
         /** Check if the tree still has the capacity for a given number
-            of children. */
-        bool check_capacity(unsigned short nu_children) const;
+            of children.
+            Takes a new chunk from the pool if the current chunk of the thread
+            does not have enough space left. Must be called before the first
+            call of add_child(). */
+        bool check_capacity(unsigned short nu_children);
 
         /** Add new child.
             It needs to be checked first with check_capacity() that the tree
@@ -77,6 +96,12 @@ public:
         /** Link the children to the parent node. */
         void link_children(Tree& tree, const Node& node);
 
+        /** Get the children that were added so far.
+            The children can still be modified with the functions of the
+            tree before link_children() is called, because they are not
+            yet visible to other threads. */
+        Children get_children() const;
+
         /** Return the node to play after the node expansion.
             This returns the child with the highest value if prior knowledge
             was used, or the first child, or null if no children. This can be
@@ -85,6 +110,8 @@ public:
         const Node* get_best_child() const;
 
     private:
+        Tree& m_tree;
+
         ThreadStorage& m_thread_storage;
 
         Float m_best_move_prior = -numeric_limits<Float>::max();
@@ -118,6 +145,8 @@ public:
 
     void set_expanding(const Node& node) { non_const(node).set_expanding(); }
 
+    void set_proven(const Node& node, Float v);
+
     void link_children(const Node& node, const Node* first_child,
                        unsigned nu_children);
 
@@ -127,37 +156,100 @@ public:
 
     void add_value_remove_loss(const Node& node, Float v);
 
+    void add_visit_count(const Node& node, Float n);
+
     void inc_visit_count(const Node& node);
 
-    void swap(Tree& tree);
-
-    /** Extract a subtree.
-        Note that you still have to re-initialize the value of the subtree
-        after the extraction because the value of the root node and the values
-        of inner nodes have a different meaning.
-        @pre Target tree is empty (! target.get_root().has_children())
-        @param target The target tree
-        @param node The root node of the subtree. */
-    void extract_subtree(Tree& target, const Node& node) const;
-
-    /** Copy a subtree.
-        The caller is responsible that the trees have the same number of
-        maximum nodes and that the target tree has room for the subtree.
-        @param target The target tree
-        @param target_node The target node
-        @param node The root node of the subtree.
-        @param min_count Don't copy subtrees of nodes below this count */
-    void copy_subtree(Tree& target, const Node& target_node, const Node& node,
-                      Float min_count) const;
+    /** Make a node the new root and remove all nodes not in its subtree.
+        Note that you still have to re-initialize the value of the new root
+        because the value of the root node and the values of inner nodes have
+        a different meaning.
+        Not thread-safe.
+        @param node The root node of the subtree to keep. */
+    void keep_subtree(const Node& node);
+
+    /** Remove the subtrees of nodes with a low count.
+        The children of the root are always kept.
+        Not thread-safe.
+        @param min_count Remove the children of non-root nodes below this
+        count. */
+    void prune(Float min_count);
+
+    /** Change the memory used by the tree.
+        Reallocates the node storage and clears the tree.
+        Not thread-safe. */
+    void set_memory(size_t memory);
+
+    /** Write the tree in a binary format.
+        The nodes are written in breadth-first order with a single write of
+        a contiguous array. The format uses the native byte order and the
+        native size of the node data and is only intended for restoring the
+        tree on the same machine. Nodes with a count of zero children are
+        written as unexpanded. */
+    void save(ostream& out) const;
+
+    /** Restore the tree from a binary format written by save().
+        Can be used with memory-mapped files, the data does not need to be
+        aligned. If the tree has less memory than the saved tree, the nodes
+        that do not fit are left out.
+        Not thread-safe.
+        @param[in,out] data The current position in the data. Advanced to the
+        end of the tree data.
+        @param end The end of the data.
+        @param is_valid_move Function that checks if a move is valid in the
+        position of the tree. Called for all nodes apart from the root.
+        @throws runtime_error If the data is invalid. The tree is cleared in
+        this case. */
+    template<class F>
+    void load(const char*& data, const char* end, F is_valid_move);
 
 private:
+    /** Size of a chunk in bytes.
+        Chunks should be large compared to the page size to keep the
+        number of pages shared by chunks of different threads small, and
+        large enough that a chunk can hold the children of any node. */
+    static constexpr size_t chunk_memory = 1 << 20;
+
+    /** Node data in the format used by save() and load(). */
+    struct SavedNode
+    {
+        Float value;
+
+        Float value_count;
+
+        Float visit_count;
+
+        Float move_prior;
+
+        /** Index of the first child in the saved node array. */
+        NodeIdx first_child;
+
+        short nu_children;
+
+        Move move;
+    };
+
+    /** Part of the node storage used by a thread. */
     struct ThreadStorage
     {
+        /** Beginning of the current chunk. */
         Node* begin;
 
+        /** End of the current chunk. */
         Node* end;
 
+        /** Next unused node in the current chunk. */
         Node* next;
+
+        /** Number of nodes used in the previous chunks of this thread since
+            the last clear(). */
+        size_t nu_nodes;
+
+        /** Chunks that were first used by this thread. */
+        vector<size_t> own_chunks;
+
+        /** Index in own_chunks of the next chunk to try to reuse. */
+        size_t own_chunks_pos;
     };
 
 
@@ -165,28 +257,51 @@ private:
 
     unique_ptr<ThreadStorage[]> m_thread_storage;
 
+    /** Flags for the chunks currently owned by a thread. */
+    unique_ptr<atomic<bool>[]> m_is_chunk_used;
+
+    /** Index of the next chunk that has never been used by any thread. */
+    atomic<size_t> m_next_new_chunk;
+
     unsigned m_nu_threads;
 
     size_t m_max_nodes;
 
-    size_t m_nodes_per_thread;
+    /** Number of nodes per chunk. */
+    size_t m_chunk_size;
 
+    size_t m_nu_chunks;
 
-    bool contains(const Node& node) const;
 
-    void copy_recurse(Tree& target, const Node& target_node, const Node& node,
-                      Float min_count) const;
+    bool acquire_chunk(size_t chunk);
 
-    unsigned get_thread_storage(const Node& node) const;
+    /** Remove unused nodes and move the remaining nodes to the beginning of
+        the node storage.
+        Does not need a second tree, the nodes are moved in place. Because
+        the children of a node are stored contiguously, the unit of memory
+        management is a block of siblings. The live blocks are found with a
+        breadth-first traversal, sorted by their position in the storage and
+        packed into the chunks in this order, which guarantees that no block
+        is moved to a higher position and that a block never overwrites
+        another block that was not moved yet.
+        @param min_count See prune() */
+    void compact(Float min_count);
+
+    bool contains(const Node& node) const;
 
     Node& non_const(const Node& node) const;
+
+    /** Make sure that the thread storage has space for a number of nodes.
+        @return false if not enough space is left in any chunk. */
+    bool reserve(ThreadStorage& thread_storage, size_t nu_nodes);
 };
 
 template<typename N>
 inline Tree<N>::NodeExpander::NodeExpander(
         unsigned thread_id, Tree& tree, [[maybe_unused]] Float child_min_count,
         [[maybe_unused]] Float max_move_prior)
-    : m_thread_storage(tree.m_thread_storage[thread_id]),
+    : m_tree(tree),
+      m_thread_storage(tree.m_thread_storage[thread_id]),
       m_first_child(m_thread_storage.next),
       m_best_child(nullptr)
 {
@@ -217,10 +332,15 @@ inline void Tree<N>::NodeExpander::add_child(const Move& mv, Float value,
 }
 
 template<typename N>
-inline bool Tree<N>::NodeExpander::check_capacity(
-        unsigned short nu_children) const
+inline bool Tree<N>::NodeExpander::check_capacity(unsigned short nu_children)
 {
-    return m_thread_storage.end - m_thread_storage.next  >= nu_children;
+    if (m_thread_storage.end - m_thread_storage.next >= nu_children)
+        return true;
+    LIBBOARDGAME_ASSERT(m_first_child == m_thread_storage.next);
+    if (! m_tree.reserve(m_thread_storage, nu_children))
+        return false;
+    m_first_child = m_thread_storage.next;
+    return true;
 }
 
 template<typename N>
@@ -229,6 +349,12 @@ inline auto Tree<N>::NodeExpander::get_best_child() const -> const Node*
     return m_best_child;
 }
 
+template<typename N>
+inline auto Tree<N>::NodeExpander::get_children() const -> Children
+{
+    return Children(m_first_child, m_thread_storage.next);
+}
+
 template<typename N>
 inline auto Tree<N>::get_children(const Node& node) const -> Children
 {
@@ -256,36 +382,21 @@ inline void Tree<N>::NodeExpander::link_children(Tree& tree, const Node& node)
 }
 
 
+template<typename N>
+bool Tree<N>::acquire_chunk(size_t chunk)
+{
+    bool expected = false;
+    return m_is_chunk_used[chunk].compare_exchange_strong(expected, true);
+}
+
 template<typename N>
 Tree<N>::Tree(size_t memory, unsigned nu_threads)
 {
     if (nu_threads == 0)
         nu_threads = 1;
-    auto max_nodes = memory / sizeof(Node);
-    // We need at least one node per thread
-    max_nodes = max(max_nodes, static_cast<size_t>(nu_threads));
-    // It doesn't make sense to set max_nodes higher than what can be accessed
-    // with NodeIdx
-    max_nodes =
-        min(max_nodes, static_cast<size_t>(numeric_limits<NodeIdx>::max()));
     m_nu_threads = nu_threads;
-    m_max_nodes = max_nodes;
-
-    // Using make_unique<Node[]>(max_nodes) slows down the array creation and
-    // thereby the startup time of Pentobi with GCC 7/8 because the compiler
-    // does not optimize away the call to the empty Move() constructor (last
-    // tested with GCC 7.2.0 and GCC 8.0.0 on Ubuntu 17.10).
-    m_nodes.reset(new Node[max_nodes]);
-
     m_thread_storage = make_unique<ThreadStorage[]>(nu_threads);
-    m_nodes_per_thread = max_nodes / nu_threads;
-    for (unsigned i = 0; i < nu_threads; ++i)
-    {
-        auto& thread_storage = m_thread_storage[i];
-        thread_storage.begin = m_nodes.get() + i * m_nodes_per_thread;
-        thread_storage.end = thread_storage.begin + m_nodes_per_thread;
-    }
-    clear();
+    set_memory(memory);
 }
 
 template<typename N>
@@ -303,82 +414,136 @@ inline void Tree<N>::add_value(const Node& node, Float v, Float weight)
 template<typename N>
 void Tree<N>::clear()
 {
-    m_thread_storage[0].next = m_thread_storage[0].begin + 1;
-    for (unsigned i = 1; i < m_nu_threads; ++i)
-        m_thread_storage[i].next = m_thread_storage[i].begin;
+    for (size_t i = 0; i < m_nu_chunks; ++i)
+        m_is_chunk_used[i].store(false, memory_order_relaxed);
+    for (unsigned i = 0; i < m_nu_threads; ++i)
+    {
+        auto& thread_storage = m_thread_storage[i];
+        thread_storage.begin = nullptr;
+        thread_storage.end = nullptr;
+        thread_storage.next = nullptr;
+        thread_storage.nu_nodes = 0;
+        thread_storage.own_chunks_pos = 0;
+    }
     m_nodes[0].init_root();
 }
 
 template<typename N>
-bool Tree<N>::contains(const Node& node) const
+void Tree<N>::compact(Float min_count)
 {
-    return &node >= m_nodes.get() && &node < m_nodes.get() + m_max_nodes;
-}
+    struct Block
+    {
+        NodeIdx begin;
 
-template<typename N>
-void Tree<N>::copy_subtree(Tree& target, const Node& target_node,
-                           const Node& node, Float min_count) const
-{
-    target.non_const(target_node).copy_data_from(node);
-    if (node.get_nu_children() > 0)
-        copy_recurse(target, target_node, node, min_count);
-    else
-        target.non_const(target_node).unlink_children_st();
-}
+        NodeIdx parent;
 
-template<typename N>
-void Tree<N>::copy_recurse(Tree& target, const Node& target_node,
-                           const Node& node, Float min_count) const
-{
-    LIBBOARDGAME_ASSERT(target.m_max_nodes == m_max_nodes);
-    LIBBOARDGAME_ASSERT(target.m_nu_threads == m_nu_threads);
-    LIBBOARDGAME_ASSERT(contains(node));
-    LIBBOARDGAME_ASSERT(node.get_nu_children() > 0);
-    auto nu_children = static_cast<unsigned>(node.get_nu_children());
-    auto& first_child = get_node(node.get_first_child());
-    // Create target children in the equivalent thread storage as in source.
-    // This ensures that the thread storage will not overflow (because the
-    // trees have identical nu_threads/max_nodes)
-    ThreadStorage& thread_storage =
-        target.m_thread_storage[get_thread_storage(first_child)];
-    auto target_child = thread_storage.next;
-    auto target_first_child =
-        static_cast<NodeIdx>(target_child - target.m_nodes.get());
-    target.non_const(target_node).link_children_st(target_first_child,
-                                                   nu_children);
-    thread_storage.next += nu_children;
-    LIBBOARDGAME_ASSERT(thread_storage.next < thread_storage.end);
-    auto end = &first_child + nu_children;
-    for (auto i = &first_child; i != end; ++i, ++target_child)
+        unsigned short size;
+    };
+
+    vector<Block> blocks;
+    auto& root = m_nodes[0];
+    if (root.get_nu_children() > 0)
+        blocks.push_back({root.get_first_child(), 0,
+                          static_cast<unsigned short>(root.get_nu_children())});
+    else
+        root.unlink_children_st();
+    // Breadth-first traversal using the vector of blocks as the queue
+    for (size_t i = 0; i < blocks.size(); ++i)
     {
-        target_child->copy_data_from(*i);
-        if (i->get_nu_children() <= 0 || i->get_visit_count() < min_count)
+        auto block = blocks[i];
+        for (auto j = block.begin; j < block.begin + block.size; ++j)
         {
-            target_child->unlink_children_st();
+            auto& node = m_nodes[j];
+            if (node.get_nu_children() <= 0
+                    || node.get_visit_count() < min_count)
+            {
+                node.unlink_children_st();
+                continue;
+            }
+            blocks.push_back(
+                {node.get_first_child(), j,
+                 static_cast<unsigned short>(node.get_nu_children())});
+        }
+    }
+    sort(blocks.begin(), blocks.end(),
+         [](const Block& b1, const Block& b2) { return b1.begin < b2.begin; });
+    // Assign the new positions. The parent is still at its old position
+    // because parents are moved in the next loop.
+    size_t chunk = 0;
+    size_t pos = 0;
+    for (auto& block : blocks)
+    {
+        if (pos + block.size > m_chunk_size)
+        {
+            ++chunk;
+            pos = 0;
+        }
+        auto new_begin = static_cast<NodeIdx>(1 + chunk * m_chunk_size + pos);
+        m_nodes[block.parent].link_children_st(new_begin, block.size);
+        block.parent = new_begin; // Reuse member to remember new position
+        pos += block.size;
+    }
+    // Move the blocks. The new position is never higher than the old one.
+    for (auto& block : blocks)
+    {
+        auto new_begin = block.parent;
+        LIBBOARDGAME_ASSERT(new_begin <= block.begin);
+        if (new_begin == block.begin)
             continue;
+        for (unsigned short i = 0; i < block.size; ++i)
+        {
+            auto& from = m_nodes[block.begin + i];
+            auto& to = m_nodes[new_begin + i];
+            to.copy_data_from(from);
+            if (from.get_nu_children() > 0)
+                to.link_children_st(from.get_first_child(),
+                                    from.get_nu_children());
+            else
+                to.unlink_children_st();
         }
-        copy_recurse(target, *target_child, *i, min_count);
+    }
+    // All remaining nodes are now owned by the first thread, the other
+    // threads will take new chunks when they need them.
+    size_t nu_nodes = 0;
+    for (auto& block : blocks)
+        nu_nodes += block.size;
+    size_t nu_used_chunks = (blocks.empty() ? 0 : chunk + 1);
+    for (size_t i = 0; i < m_nu_chunks; ++i)
+        m_is_chunk_used[i].store(i < nu_used_chunks, memory_order_relaxed);
+    for (unsigned i = 0; i < m_nu_threads; ++i)
+    {
+        auto& thread_storage = m_thread_storage[i];
+        thread_storage.begin = nullptr;
+        thread_storage.end = nullptr;
+        thread_storage.next = nullptr;
+        thread_storage.nu_nodes = 0;
+        thread_storage.own_chunks_pos = 0;
+    }
+    if (nu_used_chunks > 0)
+    {
+        auto& thread_storage = m_thread_storage[0];
+        thread_storage.begin = m_nodes.get() + 1 + chunk * m_chunk_size;
+        thread_storage.end = thread_storage.begin + m_chunk_size;
+        thread_storage.next = thread_storage.begin + pos;
+        thread_storage.nu_nodes = nu_nodes - pos;
     }
 }
 
 template<typename N>
-void Tree<N>::extract_subtree(Tree& target, const Node& node) const
+bool Tree<N>::contains(const Node& node) const
 {
-    LIBBOARDGAME_ASSERT(contains(node));
-    LIBBOARDGAME_ASSERT(&target != this);
-    LIBBOARDGAME_ASSERT(target.m_max_nodes == m_max_nodes);
-    LIBBOARDGAME_ASSERT(target.get_root().get_nu_children() <= 0);
-    copy_subtree(target, target.m_nodes[0], node, 0);
+    return &node >= m_nodes.get() && &node < m_nodes.get() + m_max_nodes;
 }
 
 template<typename N>
 size_t Tree<N>::get_nu_nodes() const
 {
-    size_t result = 0;
+    size_t result = 1; // Root node
     for (unsigned i = 0; i < m_nu_threads; ++i)
     {
         auto& thread_storage = m_thread_storage[i];
-        result += thread_storage.next - thread_storage.begin;
+        result += thread_storage.nu_nodes
+                + (thread_storage.next - thread_storage.begin);
     }
     return result;
 }
@@ -389,12 +554,57 @@ inline auto Tree<N>::get_root() const -> const Node&
     return m_nodes[0];
 }
 
-/** Get the thread storage a node belongs to. */
 template<typename N>
-inline unsigned Tree<N>::get_thread_storage(const Node& node) const
+void Tree<N>::save(ostream& out) const
 {
-    size_t diff = &node - m_nodes.get();
-    return static_cast<unsigned>(diff / m_nodes_per_thread);
+    vector<SavedNode> saved_nodes;
+    saved_nodes.reserve(get_nu_nodes());
+    vector<const Node*> nodes;
+    nodes.reserve(get_nu_nodes());
+    auto add = [&](const Node& node) {
+        SavedNode saved;
+        saved.value = node.get_value();
+        saved.value_count = node.get_value_count();
+        saved.visit_count = node.get_visit_count();
+        saved.move_prior = node.get_move_prior();
+        saved.first_child = 0;
+        saved.nu_children = 0;
+        saved.move = node.get_move();
+        saved_nodes.push_back(saved);
+        nodes.push_back(&node);
+    };
+    add(get_root());
+    // Breadth-first traversal using the vector of nodes as the queue
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        auto nu_children = nodes[i]->get_nu_children();
+        if (nu_children <= 0)
+            continue;
+        saved_nodes[i].first_child = static_cast<NodeIdx>(nodes.size());
+        saved_nodes[i].nu_children = nu_children;
+        for (auto& child : get_children(*nodes[i]))
+            add(child);
+    }
+    write_binary(out, static_cast<uint64_t>(saved_nodes.size()));
+    out.write(reinterpret_cast<const char*>(saved_nodes.data()),
+              static_cast<streamsize>(saved_nodes.size() * sizeof(SavedNode)));
+}
+
+template<typename N>
+void Tree<N>::keep_subtree(const Node& node)
+{
+    LIBBOARDGAME_ASSERT(contains(node));
+    auto& root = m_nodes[0];
+    if (&node != &root)
+    {
+        root.copy_data_from(node);
+        if (node.get_nu_children() > 0)
+            root.link_children_st(node.get_first_child(),
+                                  node.get_nu_children());
+        else
+            root.unlink_children_st();
+    }
+    compact(0);
 }
 
 template<typename N>
@@ -430,23 +640,173 @@ inline void Tree<N>::add_value_remove_loss(const Node& node, Float v)
 }
 
 template<typename N>
-void Tree<N>::swap(Tree& tree)
+inline void Tree<N>::add_visit_count(const Node& node, Float n)
+{
+    non_const(node).add_visit_count(n);
+}
+
+template<typename N>
+inline void Tree<N>::set_proven(const Node& node, Float v)
+{
+    non_const(node).set_proven(v);
+}
+
+template<typename N>
+template<class F>
+void Tree<N>::load(const char*& data, const char* end, F is_valid_move)
 {
-    // Reminder to update this function when the class gets additional members
-    struct Dummy
+    static_assert(is_trivially_copyable_v<SavedNode>);
+    clear();
+    uint64_t nu_nodes;
+    read_binary(data, end, nu_nodes);
+    if (nu_nodes == 0
+            || nu_nodes > static_cast<size_t>(end - data) / sizeof(SavedNode))
+        throw runtime_error("invalid tree data");
+    auto saved_nodes = data;
+    data += nu_nodes * sizeof(SavedNode);
+    // Index of the node in this tree for each saved node. Zero for saved
+    // nodes that are left out because they do not fit into the tree.
+    vector<NodeIdx> idx(nu_nodes, 0);
+    // In breadth-first order, the next child block always starts at this
+    // index
+    uint64_t next_child = 1;
+    auto& thread_storage = m_thread_storage[0];
+    for (uint64_t i = 0; i < nu_nodes; ++i)
     {
-        unsigned m_nu_threads;
-        size_t m_max_nodes;
-        size_t m_nodes_per_thread;
-        unique_ptr<ThreadStorage> m_thread_storage;
-        unique_ptr<Node[]> m_nodes;
-    };
-    static_assert(sizeof(Tree) == sizeof(Dummy));
-    std::swap(m_nu_threads, tree.m_nu_threads);
-    std::swap(m_max_nodes, tree.m_max_nodes);
-    std::swap(m_nodes_per_thread, tree.m_nodes_per_thread);
-    m_thread_storage.swap(tree.m_thread_storage);
-    m_nodes.swap(tree.m_nodes);
+        SavedNode saved;
+        auto p = saved_nodes + i * sizeof(SavedNode);
+        read_binary(p, data, saved);
+        if (i > 0 && ! is_valid_move(saved.move))
+        {
+            clear();
+            throw runtime_error("invalid tree data");
+        }
+        auto nu_children = saved.nu_children;
+        if (nu_children > 0)
+        {
+            // Also done for nodes that are left out, otherwise the child
+            // blocks of all following nodes would not match next_child
+            if (saved.first_child != next_child
+                    || static_cast<uint64_t>(nu_children)
+                       > nu_nodes - next_child)
+            {
+                clear();
+                throw runtime_error("invalid tree data");
+            }
+            next_child += nu_children;
+        }
+        if (i > 0 && idx[i] == 0)
+            continue;
+        auto& node = m_nodes[idx[i]];
+        node.restore(saved.move, saved.value, saved.value_count,
+                     saved.visit_count, saved.move_prior);
+        if (nu_children <= 0)
+        {
+            node.unlink_children_st();
+            continue;
+        }
+        if (! reserve(thread_storage, nu_children))
+        {
+            node.unlink_children_st();
+            continue;
+        }
+        auto first_child =
+                static_cast<NodeIdx>(thread_storage.next - m_nodes.get());
+        for (short j = 0; j < nu_children; ++j)
+            idx[saved.first_child + j] = first_child + j;
+        thread_storage.next += nu_children;
+        node.link_children_st(first_child, nu_children);
+    }
+}
+
+template<typename N>
+void Tree<N>::prune(Float min_count)
+{
+    compact(min_count);
+}
+
+template<typename N>
+bool Tree<N>::reserve(ThreadStorage& thread_storage, size_t nu_nodes)
+{
+    if (static_cast<size_t>(thread_storage.end - thread_storage.next)
+            >= nu_nodes)
+        return true;
+    if (nu_nodes > m_chunk_size)
+        return false;
+    size_t chunk = m_nu_chunks;
+    // Prefer chunks that were first used by this thread
+    auto& own_chunks = thread_storage.own_chunks;
+    while (thread_storage.own_chunks_pos < own_chunks.size())
+    {
+        auto i = own_chunks[thread_storage.own_chunks_pos++];
+        if (acquire_chunk(i))
+        {
+            chunk = i;
+            break;
+        }
+    }
+    // Then chunks that were never used
+    while (chunk == m_nu_chunks)
+    {
+        auto i = m_next_new_chunk.fetch_add(1, memory_order_relaxed);
+        if (i >= m_nu_chunks)
+        {
+            // Avoid overflow if fetch_add() is called again
+            m_next_new_chunk.store(m_nu_chunks, memory_order_relaxed);
+            break;
+        }
+        if (acquire_chunk(i))
+        {
+            own_chunks.push_back(i);
+            chunk = i;
+        }
+    }
+    // Then any chunk not currently used (first used by other threads)
+    for (size_t i = 0; chunk == m_nu_chunks && i < m_nu_chunks; ++i)
+        if (acquire_chunk(i))
+            chunk = i;
+    if (chunk == m_nu_chunks)
+        return false;
+    thread_storage.nu_nodes += (thread_storage.next - thread_storage.begin);
+    thread_storage.begin = m_nodes.get() + 1 + chunk * m_chunk_size;
+    thread_storage.end = thread_storage.begin + m_chunk_size;
+    thread_storage.next = thread_storage.begin;
+    return true;
+}
+
+template<typename N>
+void Tree<N>::set_memory(size_t memory)
+{
+    auto nu_threads = m_nu_threads;
+    auto max_nodes = memory / sizeof(Node);
+    // We need at least one node per thread and the root node
+    max_nodes = max(max_nodes, static_cast<size_t>(nu_threads) + 1);
+    // It doesn't make sense to set max_nodes higher than what can be accessed
+    // with NodeIdx
+    max_nodes =
+        min(max_nodes, static_cast<size_t>(numeric_limits<NodeIdx>::max()));
+    m_max_nodes = max_nodes;
+
+    // Using make_unique<Node[]>(max_nodes) slows down the array creation and
+    // thereby the startup time of Pentobi with GCC 7/8 because the compiler
+    // does not optimize away the call to the empty Move() constructor (last
+    // tested with GCC 7.2.0 and GCC 8.0.0 on Ubuntu 17.10).
+    // This also does not touch the memory of the nodes, which is important
+    // for the first-touch NUMA allocation of the chunks.
+    m_nodes.reset();
+    m_nodes.reset(new Node[max_nodes]);
+
+    // The root node is not part of any chunk. Use smaller chunks if the
+    // memory is small, such that each thread can get at least one chunk.
+    m_chunk_size = max(chunk_memory / sizeof(Node), size_t(1));
+    m_chunk_size = min(m_chunk_size, (max_nodes - 1) / nu_threads);
+    m_nu_chunks = (max_nodes - 1) / m_chunk_size;
+    m_is_chunk_used = make_unique<atomic<bool>[]>(m_nu_chunks);
+    // The chunk indices of the old storage are no longer valid
+    for (unsigned i = 0; i < nu_threads; ++i)
+        m_thread_storage[i].own_chunks.clear();
+    m_next_new_chunk.store(0);
+    clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -34,4 +34,40 @@ LIBBOARDGAME_TEST_CASE(libboardgame_mcts_node_add_value_remove_loss)
     LIBBOARDGAME_CHECK_CLOSE(node.get_value(), 3.5f, 1e-4f);
 }
 
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_node_compact)
+{
+    using Node = libboardgame_mcts::Node<short, double, true, true>;
+    LIBBOARDGAME_CHECK_EQUAL(sizeof(Node), 32u);
+    Node node;
+    node.init(0, 0.5, 0, 0.1234);
+    LIBBOARDGAME_CHECK_CLOSE(node.get_move_prior(), 0.1234, 0.4);
+    node.add_value(5);
+    LIBBOARDGAME_CHECK_CLOSE(node.get_value(), 5., 1e-8);
+    for (int i = 0; i < 100000; ++i)
+        node.inc_visit_count();
+    node.add_visit_count(3);
+    LIBBOARDGAME_CHECK_EQUAL(node.get_visit_count(), 100003.);
+    LIBBOARDGAME_CHECK_EQUAL(Node::max_visit_count,
+                             size_t(numeric_limits<uint_least32_t>::max()));
+    LIBBOARDGAME_CHECK_EQUAL(
+                (libboardgame_mcts::Node<short, float, true, true>
+                 ::max_visit_count), (size_t(1) << 24) - 1);
+}
+
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_node_proven)
+{
+    using Node = libboardgame_mcts::Node<int, float, true>;
+    Node node;
+    node.init(0, 0.5, 1, 1);
+    LIBBOARDGAME_CHECK(! node.is_proven());
+    node.set_proven(1);
+    LIBBOARDGAME_CHECK(node.is_proven());
+    // Adding values or virtual losses does not change a proven value
+    node.add_value(0);
+    node.add_value_remove_loss(0.3f);
+    node.add_value(0.2f, 100);
+    LIBBOARDGAME_CHECK(node.is_proven());
+    LIBBOARDGAME_CHECK_EQUAL(node.get_value(), 1.f);
+}
+
 //-----------------------------------------------------------------------------
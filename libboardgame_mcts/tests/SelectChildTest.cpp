@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_mcts/tests/SelectChildTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libboardgame_mcts/SelectChild.h"
+
+#include <memory>
+#include <random>
+#include "libboardgame_mcts/Node.h"
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using libboardgame_mcts::select_child_blocked;
+using libboardgame_mcts::select_child_scalar;
+
+//-----------------------------------------------------------------------------
+
+/** Test that select_child_blocked() selects the same child as
+    select_child_scalar() for numbers of children that are smaller, equal
+    and not a multiple of the block size. */
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_select_child_blocked)
+{
+    using Node = libboardgame_mcts::Node<int, float, true>;
+    mt19937 generator;
+    uniform_real_distribution<float> value_dist(0, 1);
+    uniform_real_distribution<float> count_dist(1, 1000);
+    float expl_factor = 0.5f;
+    float expl_limit = expl_factor;
+    for (unsigned nu_children : { 1, 3, 8, 17, 200 })
+        for (unsigned i = 0; i < 100; ++i)
+        {
+            auto nodes = make_unique<Node[]>(nu_children);
+            for (unsigned j = 0; j < nu_children; ++j)
+                nodes[j].restore(int(j), value_dist(generator),
+                                 count_dist(generator), 0,
+                                 value_dist(generator));
+            libboardgame_base::Range<const Node> children(
+                        nodes.get(), nodes.get() + nu_children);
+            auto expected =
+                    select_child_scalar(children, expl_factor, expl_limit);
+            LIBBOARDGAME_CHECK_EQUAL(
+                        select_child_blocked<8>(children, expl_factor),
+                        expected);
+            LIBBOARDGAME_CHECK_EQUAL(
+                        select_child_blocked<16>(children, expl_factor),
+                        expected);
+        }
+}
+
+/** Test that the first of several children with the same selection value
+    is selected. */
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_select_child_blocked_equal)
+{
+    using Node = libboardgame_mcts::Node<int, float, true>;
+    unsigned nu_children = 20;
+    auto nodes = make_unique<Node[]>(nu_children);
+    for (unsigned j = 0; j < nu_children; ++j)
+        nodes[j].restore(int(j), j < 10 ? 0.f : 0.5f, 1, 0, 1);
+    libboardgame_base::Range<const Node> children(
+                nodes.get(), nodes.get() + nu_children);
+    LIBBOARDGAME_CHECK_EQUAL(
+                select_child_blocked<8>(children, 0.1f)->get_move(), 10);
+    LIBBOARDGAME_CHECK_EQUAL(
+                select_child_scalar(children, 0.1f, 0.1f)->get_move(), 10);
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_mcts/tests/TranspositionTableTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libboardgame_mcts/TranspositionTable.h"
+
+#include <memory>
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using libboardgame_mcts::TranspositionTable;
+
+//-----------------------------------------------------------------------------
+
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_transposition_table_add_value)
+{
+    auto tt = make_unique<TranspositionTable<float, true>>(16);
+    float value;
+    float count;
+    LIBBOARDGAME_CHECK(! tt->lookup(3, value, count));
+    tt->add_value(3, 1);
+    tt->add_value(3, 0);
+    LIBBOARDGAME_CHECK(tt->lookup(3, value, count));
+    LIBBOARDGAME_CHECK_CLOSE(value, 0.5f, 1e-4f);
+    LIBBOARDGAME_CHECK_CLOSE(count, 2.f, 1e-4f);
+}
+
+/** Test that an entry is replaced by a position with the same index. */
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_transposition_table_replace)
+{
+    auto tt = make_unique<TranspositionTable<float, true>>(16);
+    float value;
+    float count;
+    tt->add_value(3, 1);
+    tt->add_value(3 + 16, 0);
+    LIBBOARDGAME_CHECK(! tt->lookup(3, value, count));
+    LIBBOARDGAME_CHECK(tt->lookup(3 + 16, value, count));
+    LIBBOARDGAME_CHECK_CLOSE(value, 0.f, 1e-4f);
+    LIBBOARDGAME_CHECK_CLOSE(count, 1.f, 1e-4f);
+    tt->clear();
+    LIBBOARDGAME_CHECK(! tt->lookup(3 + 16, value, count));
+}
+
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_transposition_table_get_size)
+{
+    using TT = TranspositionTable<float, true>;
+    LIBBOARDGAME_CHECK_EQUAL(TT::get_size(TT::get_memory(16), 1024), 16u);
+    LIBBOARDGAME_CHECK_EQUAL(TT::get_size(TT::get_memory(16) - 1, 1024), 8u);
+    LIBBOARDGAME_CHECK_EQUAL(TT::get_size(TT::get_memory(16), 4), 4u);
+    LIBBOARDGAME_CHECK_EQUAL(TT::get_size(0, 1024), 0u);
+}
+
+//-----------------------------------------------------------------------------
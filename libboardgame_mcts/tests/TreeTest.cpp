@@ -0,0 +1,192 @@
+//-----------------------------------------------------------------------------
+/** @file libboardgame_mcts/tests/TreeTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libboardgame_mcts/Tree.h"
+
+#include <sstream>
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+using Node = libboardgame_mcts::Node<int, float, true>;
+
+using Tree = libboardgame_mcts::Tree<Node>;
+
+/** Expand a node with a number of children in a given thread.
+    @return false if the tree had no capacity left. */
+bool expand(Tree& tree, const Node& node, unsigned thread_id,
+            unsigned short nu_children)
+{
+    Tree::NodeExpander expander(thread_id, tree, 0, 1);
+    if (! expander.check_capacity(nu_children))
+        return false;
+    for (unsigned short i = 0; i < nu_children; ++i)
+        expander.add_child(i, 0, 0, 1);
+    expander.link_children(tree, node);
+    return true;
+}
+
+bool is_valid_move(int mv)
+{
+    return mv >= 0 && mv < 100;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+/** Test that a thread can use the memory not used by other threads. */
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_tree_unbalanced_threads)
+{
+    unsigned nu_threads = 4;
+    size_t max_nodes = 1001;
+    Tree tree(max_nodes * sizeof(Node), nu_threads);
+    // Expand only in the last thread until the tree is full
+    auto node = &tree.get_root();
+    while (expand(tree, *node, nu_threads - 1, 5))
+        node = &*tree.get_children(*node).begin();
+    LIBBOARDGAME_CHECK(tree.get_nu_nodes() > max_nodes - 5 * nu_threads);
+    LIBBOARDGAME_CHECK(tree.get_nu_nodes() <= max_nodes);
+    tree.clear();
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 1u);
+    LIBBOARDGAME_CHECK(expand(tree, tree.get_root(), 0, 5));
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 6u);
+}
+
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_tree_keep_subtree)
+{
+    Tree tree(1001 * sizeof(Node), 2);
+    LIBBOARDGAME_CHECK(expand(tree, tree.get_root(), 1, 3));
+    auto& child = *(tree.get_children(tree.get_root()).begin() + 1);
+    LIBBOARDGAME_CHECK(expand(tree, child, 0, 4));
+    auto& grand_child = *(tree.get_children(child).begin() + 2);
+    LIBBOARDGAME_CHECK(expand(tree, grand_child, 1, 2));
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 10u);
+    tree.keep_subtree(child);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 7u);
+    auto& root = tree.get_root();
+    LIBBOARDGAME_CHECK_EQUAL(root.get_move(), 1);
+    LIBBOARDGAME_CHECK_EQUAL(root.get_nu_children(), 4);
+    auto& new_grand_child = *(tree.get_children(root).begin() + 2);
+    LIBBOARDGAME_CHECK_EQUAL(new_grand_child.get_move(), 2);
+    LIBBOARDGAME_CHECK_EQUAL(new_grand_child.get_nu_children(), 2);
+    // The freed nodes can be used again
+    LIBBOARDGAME_CHECK(expand(tree, *tree.get_children(root).begin(), 0, 3));
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 10u);
+}
+
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_tree_prune)
+{
+    Tree tree(1001 * sizeof(Node), 2);
+    LIBBOARDGAME_CHECK(expand(tree, tree.get_root(), 0, 2));
+    auto children = tree.get_children(tree.get_root());
+    auto& child1 = *children.begin();
+    auto& child2 = *(children.begin() + 1);
+    LIBBOARDGAME_CHECK(expand(tree, child1, 1, 3));
+    LIBBOARDGAME_CHECK(expand(tree, child2, 1, 4));
+    for (unsigned i = 0; i < 10; ++i)
+        tree.inc_visit_count(child2);
+    tree.prune(5);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 7u);
+    children = tree.get_children(tree.get_root());
+    LIBBOARDGAME_CHECK(children.begin()->is_unexpanded());
+    LIBBOARDGAME_CHECK_EQUAL((children.begin() + 1)->get_nu_children(), 4);
+}
+
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_tree_save_load)
+{
+    Tree tree(1001 * sizeof(Node), 2);
+    LIBBOARDGAME_CHECK(expand(tree, tree.get_root(), 1, 3));
+    auto& child = *(tree.get_children(tree.get_root()).begin() + 1);
+    LIBBOARDGAME_CHECK(expand(tree, child, 0, 4));
+    tree.add_value(child, 0.8f);
+    tree.inc_visit_count(child);
+    ostringstream out;
+    tree.save(out);
+    auto s = out.str();
+    Tree loaded_tree(1001 * sizeof(Node), 1);
+    const char* data = s.data();
+    loaded_tree.load(data, s.data() + s.size(), is_valid_move);
+    LIBBOARDGAME_CHECK(data == s.data() + s.size());
+    LIBBOARDGAME_CHECK_EQUAL(loaded_tree.get_nu_nodes(), 8u);
+    auto& root = loaded_tree.get_root();
+    LIBBOARDGAME_CHECK_EQUAL(root.get_nu_children(), 3);
+    auto& loaded_child = *(loaded_tree.get_children(root).begin() + 1);
+    LIBBOARDGAME_CHECK_EQUAL(loaded_child.get_move(), 1);
+    LIBBOARDGAME_CHECK_EQUAL(loaded_child.get_nu_children(), 4);
+    LIBBOARDGAME_CHECK_CLOSE(loaded_child.get_value(), child.get_value(),
+                             1e-4f);
+    LIBBOARDGAME_CHECK_CLOSE(loaded_child.get_visit_count(), 1.f, 1e-4f);
+}
+
+/** Test loading a tree into a tree with less memory.
+    The child blocks that do not fit are left out, including the subtrees of
+    the left out nodes. The blocks of the following nodes must still be
+    restored. */
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_tree_save_load_less_memory)
+{
+    Tree tree(1001 * sizeof(Node), 1);
+    LIBBOARDGAME_CHECK(expand(tree, tree.get_root(), 0, 3));
+    auto children = tree.get_children(tree.get_root());
+    auto& child1 = *children.begin();
+    auto& child2 = *(children.begin() + 1);
+    LIBBOARDGAME_CHECK(expand(tree, child1, 0, 10));
+    LIBBOARDGAME_CHECK(expand(tree, child2, 0, 2));
+    LIBBOARDGAME_CHECK(expand(tree, *tree.get_children(child1).begin(), 0,
+                              2));
+    LIBBOARDGAME_CHECK(expand(tree, *tree.get_children(child2).begin(), 0,
+                              2));
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 20u);
+    ostringstream out;
+    tree.save(out);
+    auto s = out.str();
+    // Not enough memory for the children of child1
+    Tree loaded_tree(10 * sizeof(Node), 1);
+    const char* data = s.data();
+    loaded_tree.load(data, s.data() + s.size(), is_valid_move);
+    LIBBOARDGAME_CHECK(data == s.data() + s.size());
+    LIBBOARDGAME_CHECK_EQUAL(loaded_tree.get_nu_nodes(), 8u);
+    children = loaded_tree.get_children(loaded_tree.get_root());
+    LIBBOARDGAME_CHECK(children.begin()->is_unexpanded());
+    auto& loaded_child2 = *(children.begin() + 1);
+    LIBBOARDGAME_CHECK_EQUAL(loaded_child2.get_nu_children(), 2);
+    auto& grand_child = *loaded_tree.get_children(loaded_child2).begin();
+    LIBBOARDGAME_CHECK_EQUAL(grand_child.get_nu_children(), 2);
+}
+
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_tree_set_memory)
+{
+    Tree tree(1001 * sizeof(Node), 2);
+    LIBBOARDGAME_CHECK(expand(tree, tree.get_root(), 1, 20));
+    tree.set_memory(11 * sizeof(Node));
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 1u);
+    LIBBOARDGAME_CHECK(! expand(tree, tree.get_root(), 1, 20));
+    LIBBOARDGAME_CHECK(expand(tree, tree.get_root(), 1, 5));
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_nu_nodes(), 6u);
+}
+
+/** Test that loading fails if the data contains an invalid move. */
+LIBBOARDGAME_TEST_CASE(libboardgame_mcts_tree_load_invalid_move)
+{
+    Tree tree(1001 * sizeof(Node), 1);
+    LIBBOARDGAME_CHECK(expand(tree, tree.get_root(), 0, 3));
+    ostringstream out;
+    tree.save(out);
+    auto s = out.str();
+    Tree loaded_tree(1001 * sizeof(Node), 1);
+    const char* data = s.data();
+    LIBBOARDGAME_CHECK_THROW(
+                loaded_tree.load(data, s.data() + s.size(),
+                                 [](int mv) { return mv < 2; }),
+                runtime_error);
+    LIBBOARDGAME_CHECK_EQUAL(loaded_tree.get_nu_nodes(), 1u);
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,132 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/Bitboard.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_BASE_BITBOARD_H
+#define LIBPENTOBI_BASE_BITBOARD_H
+
+#include <cstdint>
+#include <cstring>
+#include "libboardgame_base/Assert.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace libpentobi_base {
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+/** Points of a move with a bounding box of at most 5x5 points as a bit
+    pattern for Bitboard.
+    Bit 5 * dy + dx of the pattern corresponds to the point (x + dx, y + dy)
+    on the board. */
+struct MoveBits
+{
+    uint_least8_t x;
+
+    uint_least8_t y;
+
+    uint_least32_t pattern;
+};
+
+//-----------------------------------------------------------------------------
+
+/** Set of points on a board with square geometry stored as one 32-bit word
+    per row.
+    Used for checking if any point of a move is in the set with a few vector
+    instructions instead of a lookup in a grid for each point of the move.
+    Only the piece sets with a maximum piece size of 5 (Classic, Junior,
+    Callisto) are supported. This is only faster than the grid lookups if the
+    vector instructions are available (is_vectorized), so Board maintains the
+    bitboards only in this case. */
+class alignas(32) Bitboard
+{
+public:
+    /** Is intersects() implemented with AVX2 instructions? */
+#ifdef __AVX2__
+    static constexpr bool is_vectorized = true;
+#else
+    static constexpr bool is_vectorized = false;
+#endif
+
+    /** Maximum width of the board. */
+    static constexpr unsigned max_width = 32;
+
+    /** Maximum height of the board.
+        intersects() loads 8 rows starting at the top row of the move. */
+    static constexpr unsigned max_height = 25;
+
+
+    void clear() { memset(m_rows, 0, sizeof(m_rows)); }
+
+    void set(unsigned x, unsigned y);
+
+    bool get(unsigned x, unsigned y) const;
+
+    /** Add all points of a move. */
+    void set(const MoveBits& bits);
+
+    /** Check if any point of a move is in the set. */
+    bool intersects(const MoveBits& bits) const;
+
+private:
+    static constexpr unsigned nu_rows = 32;
+
+    static_assert(max_height + 7 <= nu_rows);
+
+    uint_least32_t m_rows[nu_rows];
+};
+
+inline bool Bitboard::get(unsigned x, unsigned y) const
+{
+    LIBBOARDGAME_ASSERT(x < max_width);
+    LIBBOARDGAME_ASSERT(y < max_height);
+    return (m_rows[y] & (uint_least32_t(1) << x)) != 0;
+}
+
+inline bool Bitboard::intersects(const MoveBits& bits) const
+{
+    LIBBOARDGAME_ASSERT(bits.y < max_height);
+#ifdef __AVX2__
+    auto rows = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(m_rows + bits.y));
+    rows = _mm256_srl_epi32(rows, _mm_cvtsi32_si128(bits.x));
+    // Shift counts larger than 31 give 0 in _mm256_srlv_epi32
+    auto pattern = _mm256_srlv_epi32(
+                _mm256_set1_epi32(static_cast<int>(bits.pattern)),
+                _mm256_setr_epi32(0, 5, 10, 15, 20, 32, 32, 32));
+    pattern = _mm256_and_si256(pattern, _mm256_set1_epi32(0x1f));
+    return ! _mm256_testz_si256(rows, pattern);
+#else
+    uint_least32_t result = 0;
+    for (unsigned i = 0; i < 5; ++i)
+        result |= (m_rows[bits.y + i] >> bits.x) & (bits.pattern >> (5 * i));
+    return (result & 0x1f) != 0;
+#endif
+}
+
+inline void Bitboard::set(unsigned x, unsigned y)
+{
+    LIBBOARDGAME_ASSERT(x < max_width);
+    LIBBOARDGAME_ASSERT(y < max_height);
+    m_rows[y] |= uint_least32_t(1) << x;
+}
+
+inline void Bitboard::set(const MoveBits& bits)
+{
+    LIBBOARDGAME_ASSERT(bits.y < max_height);
+    for (unsigned i = 0; i < 5; ++i)
+        m_rows[bits.y + i] |=
+                ((bits.pattern >> (5 * i)) & 0x1f) << bits.x;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
+
+#endif // LIBPENTOBI_BASE_BITBOARD_H
@@ -100,6 +100,25 @@ void Board::copy_from(const Board& bd)
     }
 }
 
+HashKey Board::compute_hash() const
+{
+    auto hash = m_zobrist->get_to_play(m_state_base.to_play);
+    for (Color c : get_colors())
+        for (Piece::IntType i = 0; i < get_nu_uniq_pieces(); ++i)
+        {
+            Piece piece(i);
+            hash ^= m_zobrist->get_nu_left_piece(c, piece,
+                                                 get_nu_left_piece(c, piece));
+        }
+    for (Point p : *m_geo)
+    {
+        auto s = m_state_base.point_state[p];
+        if (! s.is_empty())
+            hash ^= m_zobrist->get_point(s.to_color(), p);
+    }
+    return hash;
+}
+
 const Transform* Board::find_transform(Move mv) const
 {
     auto& geo = get_geometry();
@@ -280,6 +299,48 @@ bool Board::has_setup() const
     return false;
 }
 
+HashKey Board::get_canonical_hash() const
+{
+    unsigned transform;
+    return get_canonical_hash(transform);
+}
+
+HashKey Board::get_canonical_hash(unsigned& transform) const
+{
+    return get_canonical_hash(m_state_base.to_play, transform);
+}
+
+HashKey Board::get_canonical_hash(Color to_play, unsigned& transform) const
+{
+    // The key of the color to play is invariant under the transformations
+    // and is added after choosing the transformation on the key without it
+    auto hash = m_state_base.hash;
+    auto result = hash;
+    transform = 0;
+    for (unsigned i = 0; i < m_transformed_points.size(); ++i)
+    {
+        auto& transformed_points = m_transformed_points[i];
+        // Replace the keys of the occupied points by the keys of the
+        // transformed points, the other parts of the key are invariant
+        auto transformed_hash = hash;
+        for (Point p : *m_geo)
+        {
+            auto s = m_state_base.point_state[p];
+            if (s.is_empty())
+                continue;
+            auto c = s.to_color();
+            transformed_hash ^= m_zobrist->get_point(c, p)
+                    ^ m_zobrist->get_point(c, transformed_points[p]);
+        }
+        if (transformed_hash < result)
+        {
+            result = transformed_hash;
+            transform = i + 1;
+        }
+    }
+    return result ^ m_zobrist->get_to_play(to_play);
+}
+
 void Board::init(Variant variant, const Setup* setup)
 {
     if (variant != m_variant)
@@ -288,10 +349,12 @@ void Board::init(Variant variant, const Setup* setup)
     // If you make changes here, make sure that you also update copy_from()
 
     m_state_base.point_state.fill(PointState::empty(), *m_geo);
+    m_state_base.hash = 0;
     for (Color c : get_colors())
     {
         auto& state = m_state_color[c];
         state.forbidden.fill(false, *m_geo);
+        state.forbidden_bits.clear();
         state.is_attach_point.fill(false, *m_geo);
         state.pieces_left.clear();
         state.nu_onboard_pieces = 0;
@@ -300,8 +363,11 @@ void Board::init(Variant variant, const Setup* setup)
         {
             Piece piece(i);
             state.pieces_left.push_back(piece);
+            auto nu_instances = get_nu_piece_instances(piece);
             state.nu_left_piece[piece] =
-                    static_cast<uint_fast8_t>(get_nu_piece_instances(piece));
+                    static_cast<uint_fast8_t>(nu_instances);
+            m_state_base.hash ^=
+                    m_zobrist->get_nu_left_piece(c, piece, nu_instances);
         }
         m_attach_points[c].clear();
     }
@@ -397,6 +463,16 @@ void Board::init_variant(Variant variant)
     m_move_info_array = m_bc->get_move_info_array();
     m_move_info_ext_array = m_bc->get_move_info_ext_array();
     m_move_info_ext_2_array = m_bc->get_move_info_ext_2_array();
+    m_move_bits_array = m_bc->get_move_bits_array();
+    m_zobrist = &Zobrist::get();
+    vector<unique_ptr<PointTransform<Point>>> transforms;
+    vector<unique_ptr<PointTransform<Point>>> inv_transforms;
+    libpentobi_base::get_transforms(variant, transforms, inv_transforms);
+    m_transformed_points.resize(transforms.size() - 1);
+    for (unsigned i = 1; i < transforms.size(); ++i)
+        for (Point p : *m_geo)
+            m_transformed_points[i - 1][p] =
+                    transforms[i]->get_transformed(p, *m_geo);
     m_starting_points.init(variant, *m_geo);
     if (m_piece_set == PieceSet::gembloq)
         m_needed_starting_points = 4;
@@ -533,6 +609,7 @@ void Board::take_snapshot()
     m_snapshot.state_base.to_play = m_state_base.to_play;
     m_snapshot.state_base.nu_onboard_pieces_all =
         m_state_base.nu_onboard_pieces_all;
+    m_snapshot.state_base.hash = m_state_base.hash;
     m_snapshot.state_base.point_state.copy_from(m_state_base.point_state,
                                                 *m_geo);
     for (Color c : get_colors())
@@ -541,6 +618,7 @@ void Board::take_snapshot()
         const auto& state = m_state_color[c];
         auto& snapshot_state = m_snapshot.state_color[c];
         snapshot_state.forbidden.copy_from(state.forbidden, *m_geo);
+        snapshot_state.forbidden_bits = state.forbidden_bits;
         snapshot_state.is_attach_point.copy_from(state.is_attach_point,
                                                  *m_geo);
         snapshot_state.pieces_left = state.pieces_left;
@@ -548,6 +626,15 @@ void Board::take_snapshot()
         snapshot_state.nu_onboard_pieces = state.nu_onboard_pieces;
         snapshot_state.points = state.points;
     }
+    // Restoring the points changed by a move needs a random access for each
+    // point of the move (for all colors) and for its adjacent and attach
+    // points. Copying the grids needs a sequential access for each point on
+    // the board and each grid, which is about 20 times faster per point
+    // (measured on x86_64 with Classic, Trigon, Nexos and GembloQ boards).
+    auto nu_grids = 1 + 2 * m_nu_colors;
+    auto move_cost = m_max_piece_size * (1 + m_nu_colors) + m_max_adj_attach;
+    m_snapshot.max_restore_moves =
+            m_geo->get_range() * nu_grids / (20 * move_cost);
 }
 
 void Board::write(ostream& out, bool mark_last_move) const
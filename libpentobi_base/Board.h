@@ -7,6 +7,7 @@
 #ifndef LIBPENTOBI_BASE_BOARD_H
 #define LIBPENTOBI_BASE_BOARD_H
 
+#include "Bitboard.h"
 #include "BoardConst.h"
 #include "ColorMap.h"
 #include "ColorMove.h"
@@ -17,6 +18,7 @@
 #include "Setup.h"
 #include "StartingPoints.h"
 #include "Variant.h"
+#include "Zobrist.h"
 
 namespace libpentobi_base {
 
@@ -175,6 +177,37 @@ public:
 
     void write(ostream& out, bool mark_last_move = true) const;
 
+    /** Get the Zobrist hash key of the position.
+        The key depends on the point states, the number of instances left of
+        each piece and the color to play, but not on the order of the moves.
+        It is updated incrementally when a piece is placed. */
+    HashKey get_hash() const;
+
+    /** Get the minimum hash key of all positions that are equivalent to the
+        current position under the invariance transformations of the game
+        variant (see libpentobi_base::get_transforms()).
+        Not updated incrementally, needs a loop over all points for each
+        transformation. */
+    HashKey get_canonical_hash() const;
+
+    /** Get the canonical hash key and the transformation that produces it.
+        @param[out] transform The index of the transformation in the list
+        returned by libpentobi_base::get_transforms() that maps the position
+        to the position with the canonical hash key (0 for the identity). */
+    HashKey get_canonical_hash(unsigned& transform) const;
+
+    /** Get the canonical hash key of the position with a given color to
+        play.
+        The transformation is chosen independently of the color to play, so
+        the result does not depend on get_to_play().
+        @param to_play
+        @param[out] transform See get_canonical_hash(unsigned&) */
+    HashKey get_canonical_hash(Color to_play, unsigned& transform) const;
+
+    /** Compute the hash key from scratch.
+        Returns the same value as get_hash(), only needed for testing. */
+    HashKey compute_hash() const;
+
     /** Get the setup of the board before any moves were played.
         If the board was initialized without setup, the return value contains
         a setup with empty placement lists and Color(0) as the color to
@@ -227,6 +260,12 @@ public:
 
     const GridExt<bool>& is_forbidden(Color c) const;
 
+    /** Forbidden points of a color as a bitboard.
+        Only maintained if the maximum piece size is 5 and
+        Bitboard::is_vectorized is true. Use together with
+        BoardConst::get_move_bits_array(). */
+    const Bitboard& get_forbidden_bits(Color c) const;
+
     /** Check that no points of move are already occupied or adjacent to own
         color.
         Does not check if the move is diagonally adjacent to an existing
@@ -343,7 +382,9 @@ public:
         after playing moves from the snapshot position. */
     void take_snapshot();
 
-    /** See take_snapshot() */
+    /** See take_snapshot()
+        If only a few moves were played since the snapshot, only the points
+        changed by these moves are restored, otherwise the whole grids. */
     void restore_snapshot();
 
 private:
@@ -354,6 +395,9 @@ private:
 
         unsigned nu_onboard_pieces_all;
 
+        /** Zobrist hash key without the key for the color to play. */
+        HashKey hash;
+
         PointStateGrid point_state;
     };
 
@@ -362,6 +406,9 @@ private:
     {
         GridExt<bool> forbidden;
 
+        /** Same content as forbidden, see get_forbidden_bits(). */
+        Bitboard forbidden_bits;
+
         Grid<bool> is_attach_point;
 
         PiecesLeftList pieces_left;
@@ -383,6 +430,11 @@ private:
         unsigned moves_size;
 
         ColorMap<unsigned> attach_points_size;
+
+        /** Maximum number of moves played since the snapshot for restoring
+            only the changed points.
+            Above this number, copying the whole grids is faster. */
+        unsigned max_restore_moves;
     };
 
 
@@ -431,8 +483,17 @@ private:
     /** Caches m_bc->get_move_info_ext_2_array() */
     const MoveInfoExt2* m_move_info_ext_2_array;
 
+    /** Caches m_bc->get_move_bits_array() */
+    const MoveBits* m_move_bits_array;
+
     const Geometry* m_geo;
 
+    const Zobrist* m_zobrist;
+
+    /** Point mapping of each invariance transformation of the game variant
+        apart from the identity, used in get_canonical_hash(). */
+    vector<Grid<Point>> m_transformed_points;
+
     /** See is_center_section(). */
     Grid<bool> m_is_center_section;
 
@@ -475,6 +536,11 @@ private:
 
     void place_setup(const Setup& setup);
 
+    /** Restore the points changed by the moves played since the snapshot.
+        Only restores the grids, see restore_snapshot(). */
+    template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
+    void restore_snapshot_points();
+
     void write_pieces_left(ostream& out, Color c,
                            const PiecesLeftList& pieces_left, unsigned begin,
                            unsigned end) const;
@@ -529,6 +595,11 @@ inline BoardType Board::get_board_type() const
     return m_bc->get_board_type();
 }
 
+inline HashKey Board::get_hash() const
+{
+    return m_state_base.hash ^ m_zobrist->get_to_play(m_state_base.to_play);
+}
+
 inline ColorMove Board::get_move(unsigned n) const
 {
     return m_moves[n];
@@ -763,6 +834,11 @@ inline const GridExt<bool>& Board::is_forbidden(Color c) const
     return m_state_color[c].forbidden;
 }
 
+inline const Bitboard& Board::get_forbidden_bits(Color c) const
+{
+    return m_state_color[c].forbidden_bits;
+}
+
 inline bool Board::is_forbidden(Color c, Move mv) const
 {
     auto points = get_move_points(mv);
@@ -798,6 +874,9 @@ inline void Board::place(Color c, Move mv)
     auto& state_color = m_state_color[c];
     LIBBOARDGAME_ASSERT(state_color.nu_left_piece[piece] > 0);
     auto score_points = m_score_points[piece];
+    auto nu_left = state_color.nu_left_piece[piece];
+    m_state_base.hash ^= m_zobrist->get_nu_left_piece(c, piece, nu_left)
+            ^ m_zobrist->get_nu_left_piece(c, piece, nu_left - 1u);
     if (--state_color.nu_left_piece[piece] == 0)
     {
         state_color.pieces_left.remove_fast(piece);
@@ -823,6 +902,7 @@ inline void Board::place(Color c, Move mv)
     do
     {
         m_state_base.point_state[*i] = PointState(c);
+        m_state_base.hash ^= m_zobrist->get_point(c, *i);
         for_each_color([&](Color c) {
             m_state_color[c].forbidden[*i] = true;
         });
@@ -842,6 +922,16 @@ inline void Board::place(Color c, Move mv)
         LIBBOARDGAME_ASSERT(i == info_ext.begin_attach());
         end += info_ext.size_attach_points;
     }
+    if constexpr (MAX_SIZE == 5 && Bitboard::is_vectorized)
+    {
+        auto& bits = m_move_bits_array[mv.to_int()];
+        for_each_color([&](Color c) {
+            m_state_color[c].forbidden_bits.set(bits);
+        });
+        for (auto j = info_ext.begin_adj(); j != info_ext.end_adj(); ++j)
+            state_color.forbidden_bits.set(m_geo->get_x(*j),
+                                           m_geo->get_y(*j));
+    }
     auto& attach_points = m_attach_points[c];
     auto n = attach_points.size();
     do
@@ -871,27 +961,79 @@ inline void Board::play(ColorMove mv)
 inline void Board::restore_snapshot()
 {
     LIBBOARDGAME_ASSERT(m_snapshot.moves_size <= m_moves.size());
-    auto& geo = get_geometry();
+    if (m_moves.size() - m_snapshot.moves_size <= m_snapshot.max_restore_moves)
+    {
+        if (m_max_piece_size == 5)
+            restore_snapshot_points<5, 16>();
+        else if (m_max_piece_size == 6)
+            restore_snapshot_points<6, 22>();
+        else if (m_max_piece_size == 7)
+            restore_snapshot_points<7, 12>();
+        else
+            restore_snapshot_points<22, 44>();
+    }
+    else
+    {
+        auto& geo = get_geometry();
+        m_state_base.point_state.memcpy_from(
+                    m_snapshot.state_base.point_state, geo);
+        for (Color c : get_colors())
+        {
+            const auto& snapshot_state = m_snapshot.state_color[c];
+            auto& state = m_state_color[c];
+            state.forbidden.copy_from(snapshot_state.forbidden, geo);
+            state.is_attach_point.copy_from(snapshot_state.is_attach_point,
+                                            geo);
+        }
+    }
     m_moves.resize(m_snapshot.moves_size);
     m_state_base.to_play = m_snapshot.state_base.to_play;
     m_state_base.nu_onboard_pieces_all =
         m_snapshot.state_base.nu_onboard_pieces_all;
-    m_state_base.point_state.memcpy_from(m_snapshot.state_base.point_state,
-                                         geo);
+    m_state_base.hash = m_snapshot.state_base.hash;
     for (Color c : get_colors())
     {
         const auto& snapshot_state = m_snapshot.state_color[c];
         auto& state = m_state_color[c];
-        state.forbidden.copy_from(snapshot_state.forbidden, geo);
-        state.is_attach_point.copy_from(snapshot_state.is_attach_point, geo);
         state.pieces_left = snapshot_state.pieces_left;
         state.nu_left_piece = snapshot_state.nu_left_piece;
         state.nu_onboard_pieces = snapshot_state.nu_onboard_pieces;
         state.points = snapshot_state.points;
+        if (m_max_piece_size == 5 && Bitboard::is_vectorized)
+            state.forbidden_bits = snapshot_state.forbidden_bits;
         m_attach_points[c].resize(m_snapshot.attach_points_size[c]);
     }
 }
 
+template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
+inline void Board::restore_snapshot_points()
+{
+    LIBBOARDGAME_ASSERT(m_max_piece_size == MAX_SIZE);
+    LIBBOARDGAME_ASSERT(m_max_adj_attach == MAX_ADJ_ATTACH);
+    const auto& snapshot_point_state = m_snapshot.state_base.point_state;
+    for (auto i = m_snapshot.moves_size; i < m_moves.size(); ++i)
+    {
+        auto c = m_moves[i].color;
+        auto mv = m_moves[i].move;
+        auto& info = BoardConst::get_move_info<MAX_SIZE>(mv, m_move_info_array);
+        auto& info_ext = BoardConst::get_move_info_ext<MAX_ADJ_ATTACH>(
+                    mv, m_move_info_ext_array);
+        for (auto p : info)
+        {
+            m_state_base.point_state[p] = snapshot_point_state[p];
+            for (Color c : get_colors())
+                m_state_color[c].forbidden[p] =
+                        m_snapshot.state_color[c].forbidden[p];
+        }
+        auto& state = m_state_color[c];
+        const auto& snapshot_state = m_snapshot.state_color[c];
+        for (auto j = info_ext.begin_adj(); j != info_ext.end_adj(); ++j)
+            state.forbidden[*j] = snapshot_state.forbidden[*j];
+        for (auto j = info_ext.begin_attach(); j != info_ext.end_attach(); ++j)
+            state.is_attach_point[*j] = snapshot_state.is_attach_point[*j];
+    }
+}
+
 inline void Board::set_to_play(Color c)
 {
     m_state_base.to_play = c;
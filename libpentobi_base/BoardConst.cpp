@@ -7,16 +7,24 @@
 #include "BoardConst.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
 #include "Marker.h"
 #include "PieceTransformsClassic.h"
 #include "PieceTransformsGembloQ.h"
 #include "PieceTransformsTrigon.h"
+#include "libboardgame_base/BinaryIO.h"
 #include "libboardgame_base/Compiler.h"
 #include "libboardgame_base/Log.h"
 
 namespace libpentobi_base {
 
 using libboardgame_base::get_type_name;
+using libboardgame_base::read_binary;
+using libboardgame_base::write_binary;
 
 //-----------------------------------------------------------------------------
 
@@ -35,6 +43,101 @@ Marker g_marker;
 Grid<array<ArrayList<Move, 44>, PrecompMoves::nu_adj_status>>
     g_full_move_table;
 
+/** See BoardConst::set_cache_dir() */
+string g_cache_dir;
+
+/** Identifier at the beginning of cache files written by BoardConst.
+    Needs to be changed if the format changes. Changes of the move generation
+    between releases are detected by the version in CacheHeader, but this
+    identifier needs to be changed if the move generation changes between
+    builds with the same version. */
+const array<char, 16> cache_magic = {
+    'P', 'E', 'N', 'T', 'O', 'B', 'I', '-', 'M', 'O', 'V', 'E', 'S', '0', '1',
+    '\n' };
+
+/** Parameters that the data in a cache file depends on.
+    Stored after cache_magic and compared when reading the file to detect
+    files written for a different board type, by a different version of
+    Pentobi or by a build with a different memory layout of the data. */
+struct CacheHeader
+{
+    /** The Pentobi version padded with zeros.
+        Empty if the version is not known at compile time. */
+    array<char, 32> version;
+
+    uint_least32_t board_type;
+
+    uint_least32_t piece_set;
+
+    uint_least32_t range;
+
+    uint_least32_t move_info_size;
+
+    uint_least32_t move_info_ext_size;
+
+    uint_least32_t move_info_ext_2_size;
+
+    uint_least32_t precomp_moves_size;
+
+    uint_least32_t adj_status_nu_adj;
+
+    bool operator==(const CacheHeader& h) const
+    {
+        return memcmp(this, &h, sizeof(CacheHeader)) == 0;
+    }
+};
+
+CacheHeader get_cache_header(BoardType board_type, PieceSet piece_set,
+                             Move::IntType range, size_t move_info_size,
+                             size_t move_info_ext_size)
+{
+    CacheHeader h;
+    h.version.fill('\0');
+#ifdef VERSION
+    memcpy(h.version.data(), VERSION,
+           min(strlen(VERSION), h.version.size() - 1));
+#endif
+    h.board_type = static_cast<uint_least32_t>(board_type);
+    h.piece_set = static_cast<uint_least32_t>(piece_set);
+    h.range = range;
+    h.move_info_size = static_cast<uint_least32_t>(move_info_size);
+    h.move_info_ext_size = static_cast<uint_least32_t>(move_info_ext_size);
+    h.move_info_ext_2_size = sizeof(MoveInfoExt2);
+    h.precomp_moves_size = sizeof(PrecompMoves);
+    h.adj_status_nu_adj = PrecompMoves::adj_status_nu_adj;
+    return h;
+}
+
+/** Offsets of the sections in a cache file.
+    The sections are aligned to cache lines. Since the file is mapped to a
+    page-aligned address, this also satisfies the alignment of the data. */
+struct CacheLayout
+{
+    size_t move_info;
+
+    size_t move_info_ext;
+
+    size_t move_info_ext_2;
+
+    size_t precomp_moves;
+
+    size_t size;
+
+    explicit CacheLayout(const CacheHeader& h);
+
+    static size_t align(size_t n) { return (n + 63) / 64 * 64; }
+};
+
+CacheLayout::CacheLayout(const CacheHeader& h)
+{
+    move_info = align(sizeof(cache_magic) + sizeof(CacheHeader)
+                      + sizeof(PieceMap<unsigned>));
+    move_info_ext = align(move_info + h.range * h.move_info_size);
+    move_info_ext_2 = align(move_info_ext + h.range * h.move_info_ext_size);
+    precomp_moves = align(move_info_ext_2 + h.range * h.move_info_ext_2_size);
+    size = precomp_moves + h.precomp_moves_size;
+}
+
 
 bool is_reverse(MovePoints::const_iterator begin1, const Point* begin2, unsigned size)
 {
@@ -863,32 +966,24 @@ BoardConst::BoardConst(BoardType board_type, PieceSet piece_set)
         m_pieces = create_pieces_classic(m_geo, *m_transforms);
         m_max_piece_size = 5;
         m_max_adj_attach = 16;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<5>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<16>)));
         break;
     case PieceSet::junior:
         m_transforms = make_unique<PieceTransformsClassic>();
         m_pieces = create_pieces_junior(m_geo, *m_transforms);
         m_max_piece_size = 5;
         m_max_adj_attach = 16;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<5>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<16>)));
         break;
     case PieceSet::trigon:
         m_transforms = make_unique<PieceTransformsTrigon>();
         m_pieces = create_pieces_trigon(m_geo, *m_transforms);
         m_max_piece_size = 6;
         m_max_adj_attach = 22;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<6>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<22>)));
         break;
     case PieceSet::nexos:
         m_transforms = make_unique<PieceTransformsClassic>();
         m_pieces = create_pieces_nexos(m_geo, *m_transforms);
         m_max_piece_size = 7;
         m_max_adj_attach = 12;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<7>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<12>)));
         break;
     case PieceSet::callisto:
         m_transforms = make_unique<PieceTransformsClassic>();
@@ -899,29 +994,15 @@ BoardConst::BoardConst(BoardType board_type, PieceSet piece_set)
         // faster if we don't have to handle different values for
         // m_max_adj_attach for the same m_max_piece_size.
         m_max_adj_attach = 16;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<5>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<16>)));
         break;
     case PieceSet::gembloq:
         m_transforms = make_unique<PieceTransformsGembloQ>();
         m_pieces = create_pieces_gembloq(m_geo, *m_transforms);
         m_max_piece_size = 22;
         m_max_adj_attach = 44;
-        m_move_info.reset(calloc(m_range, sizeof(MoveInfo<22>)));
-        m_move_info_ext.reset(calloc(m_range, sizeof(MoveInfoExt<44>)));
         break;
     }
-    m_move_info_ext_2 = make_unique<MoveInfoExt2[]>(m_range);
     m_nu_pieces = static_cast<Piece::IntType>(m_pieces.size());
-    for (Point p : m_geo)
-        if (has_adj_status_points(p))
-            init_adj_status_points(p);
-    auto width = m_geo.get_width();
-    auto height = m_geo.get_height();
-    for (Point p : m_geo)
-        m_compare_val[p] =
-                (height - m_geo.get_y(p) - 1) * width + m_geo.get_x(p);
-    create_moves();
     switch (piece_set)
     {
     case PieceSet::classic:
@@ -943,12 +1024,35 @@ BoardConst::BoardConst(BoardType board_type, PieceSet piece_set)
         LIBBOARDGAME_ASSERT(m_nu_pieces == 21);
         break;
     }
-    if (board_type == BoardType::duo || board_type == BoardType::callisto_2)
-        init_symmetry_info<5>();
-    else if (board_type == BoardType::trigon)
-        init_symmetry_info<6>();
-    else if (board_type == BoardType::gembloq_2)
-        init_symmetry_info<22>();
+    for (Point p : m_geo)
+        if (has_adj_status_points(p))
+            init_adj_status_points(p);
+    auto width = m_geo.get_width();
+    auto height = m_geo.get_height();
+    for (Point p : m_geo)
+        m_compare_val[p] =
+                (height - m_geo.get_y(p) - 1) * width + m_geo.get_x(p);
+    bool has_symmetry_info =
+            (board_type == BoardType::duo
+             || board_type == BoardType::callisto_2
+             || board_type == BoardType::trigon
+             || board_type == BoardType::gembloq_2);
+    if (has_symmetry_info)
+        m_symmetric_points.init(m_geo);
+    if (! read_cache())
+    {
+        create_moves();
+        if (board_type == BoardType::duo
+                || board_type == BoardType::callisto_2)
+            init_symmetry_info<5>();
+        else if (board_type == BoardType::trigon)
+            init_symmetry_info<6>();
+        else if (board_type == BoardType::gembloq_2)
+            init_symmetry_info<22>();
+        write_cache();
+    }
+    if (m_max_piece_size == 5 && Bitboard::is_vectorized)
+        init_move_bits();
 }
 
 template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
@@ -960,14 +1064,15 @@ inline void BoardConst::create_move(unsigned& moves_created, Piece piece,
     LIBBOARDGAME_ASSERT(moves_created < m_range);
     Move mv(static_cast<Move::IntType>(moves_created));
     void* place =
-            static_cast<MoveInfo<MAX_SIZE>*>(m_move_info.get())
+            static_cast<MoveInfo<MAX_SIZE>*>(m_move_info_storage.get())
             + moves_created;
     new(place) MoveInfo<MAX_SIZE>(piece, points);
     place =
-            static_cast<MoveInfoExt<MAX_ADJ_ATTACH>*>(m_move_info_ext.get())
+            static_cast<MoveInfoExt<MAX_ADJ_ATTACH>*>(
+                m_move_info_ext_storage.get())
             + moves_created;
     auto& info_ext = *new(place) MoveInfoExt<MAX_ADJ_ATTACH>();
-    auto& info_ext_2 = m_move_info_ext_2[moves_created];
+    auto& info_ext_2 = m_move_info_ext_2_storage[moves_created];
     ++moves_created;
     auto scored_points = &info_ext_2.scored_points[0];
     for (auto p : points)
@@ -1031,6 +1136,15 @@ inline void BoardConst::create_move(unsigned& moves_created, Piece piece,
 
 void BoardConst::create_moves()
 {
+    m_move_info_storage.reset(calloc(m_range, get_move_info_size()));
+    m_move_info_ext_storage.reset(calloc(m_range, get_move_info_ext_size()));
+    m_move_info_ext_2_storage = make_unique<MoveInfoExt2[]>(m_range);
+    m_precomp_moves_storage = make_unique<PrecompMoves>();
+    m_move_info = m_move_info_storage.get();
+    m_move_info_ext = m_move_info_ext_storage.get();
+    m_move_info_ext_2 = m_move_info_ext_2_storage.get();
+    m_precomp_moves = m_precomp_moves_storage.get();
+
     // Unused move infos for Move::null()
     LIBBOARDGAME_ASSERT(Move::null().to_int() == 0);
     unsigned moves_created = 1;
@@ -1051,10 +1165,10 @@ void BoardConst::create_moves()
             for (unsigned j = 0; j < PrecompMoves::nu_adj_status; ++j)
                 {
                     auto& list = g_full_move_table[p][j];
-                    m_precomp_moves.set_list_range(p, j, piece, n,
-                                                   list.size());
+                    m_precomp_moves_storage->set_list_range(p, j, piece, n,
+                                                            list.size());
                     for (auto mv : list)
-                        m_precomp_moves.set_move(n++, mv);
+                        m_precomp_moves_storage->set_move(n++, mv);
                     list.clear();
                 }
     }
@@ -1171,6 +1285,37 @@ const BoardConst& BoardConst::get(Variant variant)
     return *bc;
 }
 
+string BoardConst::get_cache_file() const
+{
+    return g_cache_dir + "/pentobi-moves-"
+            + std::to_string(static_cast<int>(m_board_type)) + "-"
+            + std::to_string(static_cast<int>(m_piece_set)) + ".dat";
+}
+
+size_t BoardConst::get_move_info_size() const
+{
+    if (m_max_piece_size == 5)
+        return sizeof(MoveInfo<5>);
+    if (m_max_piece_size == 6)
+        return sizeof(MoveInfo<6>);
+    if (m_max_piece_size == 7)
+        return sizeof(MoveInfo<7>);
+    LIBBOARDGAME_ASSERT(m_max_piece_size == 22);
+    return sizeof(MoveInfo<22>);
+}
+
+size_t BoardConst::get_move_info_ext_size() const
+{
+    if (m_max_adj_attach == 16)
+        return sizeof(MoveInfoExt<16>);
+    if (m_max_adj_attach == 22)
+        return sizeof(MoveInfoExt<22>);
+    if (m_max_adj_attach == 12)
+        return sizeof(MoveInfoExt<12>);
+    LIBBOARDGAME_ASSERT(m_max_adj_attach == 44);
+    return sizeof(MoveInfoExt<44>);
+}
+
 Piece BoardConst::get_move_piece(Move mv) const
 {
     if (m_max_piece_size == 5)
@@ -1289,15 +1434,45 @@ void BoardConst::init_adj_status_points(Point p)
     LIBBOARDGAME_ASSERT(n == max_size);
 }
 
+void BoardConst::init_move_bits()
+{
+    LIBBOARDGAME_ASSERT(m_max_piece_size == 5);
+    LIBBOARDGAME_ASSERT(m_geo.get_width() <= Bitboard::max_width);
+    LIBBOARDGAME_ASSERT(m_geo.get_height() <= Bitboard::max_height);
+    m_move_bits = make_unique<MoveBits[]>(m_range);
+    m_move_bits[0] = {0, 0, 0}; // Move::null()
+    for (Move::IntType i = 1; i < m_range; ++i)
+    {
+        auto& info = get_move_info<5>(Move(i));
+        auto min_x = numeric_limits<unsigned>::max();
+        auto min_y = numeric_limits<unsigned>::max();
+        for (Point p : info)
+        {
+            min_x = min(min_x, m_geo.get_x(p));
+            min_y = min(min_y, m_geo.get_y(p));
+        }
+        auto& bits = m_move_bits[i];
+        bits.x = static_cast<uint_least8_t>(min_x);
+        bits.y = static_cast<uint_least8_t>(min_y);
+        bits.pattern = 0;
+        for (Point p : info)
+        {
+            auto dx = m_geo.get_x(p) - min_x;
+            auto dy = m_geo.get_y(p) - min_y;
+            LIBBOARDGAME_ASSERT(dx < 5 && dy < 5);
+            bits.pattern |= uint_least32_t(1) << (5 * dy + dx);
+        }
+    }
+}
+
 template<unsigned MAX_SIZE>
 void BoardConst::init_symmetry_info()
 {
-    m_symmetric_points.init(m_geo);
     for (Move::IntType i = 1; i < m_range; ++i)
     {
         Move mv(i);
         auto& info = get_move_info<MAX_SIZE>(mv);
-        auto& info_ext_2 = m_move_info_ext_2[i];
+        auto& info_ext_2 = m_move_info_ext_2_storage[i];
         info_ext_2.breaks_symmetry = false;
         array<Point, PieceInfo::max_size> sym_points;
         MovePoints::IntType n = 0;
@@ -1319,6 +1494,59 @@ void BoardConst::init_symmetry_info()
     }
 }
 
+bool BoardConst::read_cache()
+{
+    if (g_cache_dir.empty())
+        return false;
+    auto file = get_cache_file();
+    unique_ptr<MappedFile> cache;
+    try
+    {
+        cache = make_unique<MappedFile>(file);
+    }
+    catch (const runtime_error&)
+    {
+        // File does not exist yet
+        return false;
+    }
+    auto expected_header =
+            get_cache_header(m_board_type, m_piece_set, m_range,
+                             get_move_info_size(), get_move_info_ext_size());
+    CacheLayout layout(expected_header);
+    auto data = cache->get_data();
+    auto end = data + cache->get_size();
+    array<char, 16> magic;
+    CacheHeader header;
+    if (cache->get_size() != layout.size)
+    {
+        LIBBOARDGAME_LOG("Ignoring ", file, " (wrong size)");
+        return false;
+    }
+    read_binary(data, end, magic);
+    read_binary(data, end, header);
+    if (magic != cache_magic || ! (header == expected_header))
+    {
+        LIBBOARDGAME_LOG("Ignoring ", file, " (wrong format)");
+        return false;
+    }
+    read_binary(data, end, m_nu_attach_points);
+    data = cache->get_data();
+    m_move_info = data + layout.move_info;
+    m_move_info_ext = data + layout.move_info_ext;
+    m_move_info_ext_2 = reinterpret_cast<const MoveInfoExt2*>(
+                data + layout.move_info_ext_2);
+    m_precomp_moves =
+            reinterpret_cast<const PrecompMoves*>(data + layout.precomp_moves);
+    m_cache = move(cache);
+    LIBBOARDGAME_LOG("Using moves from ", file);
+    return true;
+}
+
+void BoardConst::set_cache_dir(const string& dir)
+{
+    g_cache_dir = dir;
+}
+
 void BoardConst::sort(MovePoints& points) const
 {
     auto less = [this](Point a, Point b)
@@ -1420,6 +1648,47 @@ string BoardConst::to_string(Move mv, bool with_piece_name) const
     return s.str();
 }
 
+void BoardConst::write_cache() const
+{
+    if (g_cache_dir.empty())
+        return;
+    auto header =
+            get_cache_header(m_board_type, m_piece_set, m_range,
+                             get_move_info_size(), get_move_info_ext_size());
+    CacheLayout layout(header);
+    auto pad = [](ostream& out, size_t offset) {
+        while (static_cast<size_t>(out.tellp()) < offset)
+            out.put('\0');
+    };
+    // Write to a temporary file and rename it, such that other processes
+    // never see a partially written file
+    auto file = get_cache_file();
+    auto tmp_file = file + ".tmp" + std::to_string(random_device()());
+    ofstream out(tmp_file, ios::binary);
+    write_binary(out, cache_magic);
+    write_binary(out, header);
+    write_binary(out, m_nu_attach_points);
+    pad(out, layout.move_info);
+    out.write(static_cast<const char*>(m_move_info),
+              static_cast<streamsize>(m_range * header.move_info_size));
+    pad(out, layout.move_info_ext);
+    out.write(static_cast<const char*>(m_move_info_ext),
+              static_cast<streamsize>(m_range * header.move_info_ext_size));
+    pad(out, layout.move_info_ext_2);
+    out.write(reinterpret_cast<const char*>(m_move_info_ext_2),
+              static_cast<streamsize>(m_range * sizeof(MoveInfoExt2)));
+    pad(out, layout.precomp_moves);
+    write_binary(out, *m_precomp_moves);
+    out.close();
+    if (! out || std::rename(tmp_file.c_str(), file.c_str()) != 0)
+    {
+        LIBBOARDGAME_LOG("Could not write ", file);
+        std::remove(tmp_file.c_str());
+        return;
+    }
+    LIBBOARDGAME_LOG("Wrote moves to ", file);
+}
+
 //-----------------------------------------------------------------------------
 
 } // namespace libpentobi_base
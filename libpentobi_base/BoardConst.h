@@ -7,15 +7,18 @@
 #ifndef LIBPENTOBI_BASE_BOARD_CONST_H
 #define LIBPENTOBI_BASE_BOARD_CONST_H
 
+#include "Bitboard.h"
 #include "MoveInfo.h"
 #include "PieceInfo.h"
 #include "PrecompMoves.h"
 #include "SymmetricPoints.h"
 #include "Variant.h"
+#include "libboardgame_base/MappedFile.h"
 #include "libboardgame_base/Range.h"
 
 namespace libpentobi_base {
 
+using libboardgame_base::MappedFile;
 using libboardgame_base::Range;
 
 //-----------------------------------------------------------------------------
@@ -44,6 +47,17 @@ public:
         This function is not thread-safe. */
     static const BoardConst& get(Variant variant);
 
+    /** Set a directory for caching the precomputed move data.
+        If set, the move data of a board type and piece set is written to a
+        file in this directory when it is created for the first time. Later
+        instances (also in other processes) memory-map the file read-only
+        instead of recreating the data, which reduces the start-up time and
+        lets processes on the same host share the memory. Errors when
+        reading or writing the cache are logged and the data is created
+        without the cache. Only affects instances created after this call.
+        @param dir The directory (empty string disables the cache). */
+    static void set_cache_dir(const string& dir);
+
     template<unsigned MAX_SIZE>
     static const MoveInfo<MAX_SIZE>&
     get_move_info(Move mv, MoveInfoArray move_info_array);
@@ -83,7 +97,7 @@ public:
     template<unsigned MAX_SIZE>
     Piece get_move_piece(Move mv) const;
 
-    MoveInfoArray get_move_info_array() const { return m_move_info.get(); }
+    MoveInfoArray get_move_info_array() const { return m_move_info; }
 
     /** Get pointer to extended move info array.
         Can be used to speed up the access to the move info by avoiding the
@@ -94,6 +108,11 @@ public:
 
     const MoveInfoExt2* get_move_info_ext_2_array() const;
 
+    /** Get the bit patterns of the moves for Bitboard::intersects().
+        Only available if the maximum piece size is 5 and
+        Bitboard::is_vectorized is true, otherwise returns nullptr. */
+    const MoveBits* get_move_bits_array() const { return m_move_bits.get(); }
+
     Move::IntType get_range() const { return m_range; }
 
     bool find_move(const MovePoints& points, Move& move) const;
@@ -105,10 +124,10 @@ public:
     PrecompMoves::Range get_moves(Piece piece, Point p,
                                   unsigned adj_status = 0) const
     {
-        return m_precomp_moves.get_moves(piece, p, adj_status);
+        return m_precomp_moves->get_moves(piece, p, adj_status);
     }
 
-    const PrecompMoves& get_precomp_moves() const { return m_precomp_moves; }
+    const PrecompMoves& get_precomp_moves() const { return *m_precomp_moves; }
 
     BoardType get_board_type() const { return m_board_type; }
 
@@ -184,18 +203,39 @@ private:
 
     /** Array of MoveInfo<MAX_SIZE> with MAX_SIZE being the maximum piece size
         in the corresponding game variant.
-        See comments at MoveInfo. */
-    unique_ptr<void, MallocFree> m_move_info;
+        See comments at MoveInfo. Points to m_move_info_storage or into
+        m_cache. */
+    const void* m_move_info;
 
     /** Array of MoveInfoExt<MAX_ADJ_ATTACH> with MAX_ADJ_ATTACH being the
         maximum total number of attach points and adjacent points of a piece in
         the corresponding game variant.
-        See comments at MoveInfoExt. */
-    unique_ptr<void, MallocFree> m_move_info_ext;
+        See comments at MoveInfoExt. Points to m_move_info_ext_storage or into
+        m_cache. */
+    const void* m_move_info_ext;
+
+    /** Points to m_move_info_ext_2_storage or into m_cache. */
+    const MoveInfoExt2* m_move_info_ext_2;
+
+    /** Points to m_precomp_moves_storage or into m_cache. */
+    const PrecompMoves* m_precomp_moves;
+
+    /** Storage for the move data if it was not read from the cache. */
+    unique_ptr<void, MallocFree> m_move_info_storage;
+
+    unique_ptr<void, MallocFree> m_move_info_ext_storage;
+
+    unique_ptr<MoveInfoExt2[]> m_move_info_ext_2_storage;
 
-    unique_ptr<MoveInfoExt2[]> m_move_info_ext_2;
+    unique_ptr<PrecompMoves> m_precomp_moves_storage;
 
-    PrecompMoves m_precomp_moves;
+    /** See get_move_bits_array().
+        Not stored in the cache because it is fast to compute. */
+    unique_ptr<MoveBits[]> m_move_bits;
+
+    /** Mapped cache file if the move data was read from the cache.
+        See set_cache_dir() */
+    unique_ptr<MappedFile> m_cache;
 
     /** Value for comparing points using the ordering used in blksgf files.
         As specified in doc/blksgf/Pentobi-SGF.html, the order should be
@@ -217,13 +257,25 @@ private:
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
     void create_moves(unsigned& moves_created, Piece piece);
 
+    string get_cache_file() const;
+
+    size_t get_move_info_size() const;
+
+    size_t get_move_info_ext_size() const;
+
     template<unsigned MAX_SIZE>
     const MoveInfo<MAX_SIZE>& get_move_info(Move mv) const;
 
     void init_adj_status_points(Point p);
 
+    void init_move_bits();
+
     template<unsigned MAX_SIZE>
     void init_symmetry_info();
+
+    bool read_cache();
+
+    void write_cache() const;
 };
 
 inline const Geometry& BoardConst::get_geometry() const
@@ -244,7 +296,7 @@ template<unsigned MAX_SIZE>
 inline const MoveInfo<MAX_SIZE>& BoardConst::get_move_info(Move mv) const
 {
     LIBBOARDGAME_ASSERT(m_max_piece_size == MAX_SIZE);
-    return get_move_info<MAX_SIZE>(mv, m_move_info.get());
+    return get_move_info<MAX_SIZE>(mv, m_move_info);
 }
 
 template<unsigned MAX_ADJ_ATTACH>
@@ -264,12 +316,12 @@ inline const MoveInfoExt2& BoardConst::get_move_info_ext_2(Move mv) const
 
 inline auto BoardConst::get_move_info_ext_array() const -> MoveInfoExtArray
 {
-    return m_move_info_ext.get();
+    return m_move_info_ext;
 }
 
 inline const MoveInfoExt2* BoardConst::get_move_info_ext_2_array() const
 {
-    return m_move_info_ext_2.get();
+    return m_move_info_ext_2;
 }
 
 template<unsigned MAX_SIZE>
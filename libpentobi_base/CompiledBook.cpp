@@ -0,0 +1,290 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/CompiledBook.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "CompiledBook.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include "BoardUtil.h"
+#include "NodeUtil.h"
+#include "libboardgame_base/BinaryIO.h"
+#include "libboardgame_base/Log.h"
+
+namespace libpentobi_base {
+
+using libboardgame_base::read_binary;
+using libboardgame_base::write_binary;
+
+//-----------------------------------------------------------------------------
+
+/** Good moves of a position in a compiled book. */
+struct CompiledBook::Entry
+{
+    /** Canonical hash key of the position with the color to play. */
+    uint_least64_t key;
+
+    /** Index of the first move in the move section. */
+    uint_least32_t begin;
+
+    uint_least32_t nu_moves;
+};
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Identifier at the beginning of compiled book files.
+    Needs to be changed if the format or the hash keys change. */
+const array<char, 16> book_magic = {
+    'P', 'E', 'N', 'T', 'O', 'B', 'I', '-', 'B', 'O', 'O', 'K', '-', '0', '2',
+    '\n' };
+
+/** Parameters of a compiled book file stored after book_magic. */
+struct BookHeader
+{
+    /** Game variant as returned by to_string_id() padded with zeros. */
+    array<char, 32> variant;
+
+    /** Number of moves of the board type.
+        Used to detect books compiled by a version with a different move
+        numbering. */
+    uint_least32_t move_range;
+
+    uint_least32_t nu_entries;
+
+    uint_least32_t nu_moves;
+};
+
+/** Offsets of the sections in a compiled book file.
+    The sections are aligned to cache lines. Since the file is mapped to a
+    page-aligned address, this also satisfies the alignment of the data. */
+struct BookLayout
+{
+    size_t entries;
+
+    size_t moves;
+
+    size_t size;
+
+    BookLayout(size_t entry_size, const BookHeader& h);
+
+    static size_t align(size_t n) { return (n + 63) / 64 * 64; }
+};
+
+BookLayout::BookLayout(size_t entry_size, const BookHeader& h)
+{
+    entries = align(sizeof(book_magic) + sizeof(BookHeader));
+    moves = align(entries + h.nu_entries * entry_size);
+    size = moves + h.nu_moves * sizeof(Move::IntType);
+}
+
+/** A good move in the orientation of the canonical position. */
+struct BookMove
+{
+    HashKey key;
+
+    Move::IntType move;
+
+    bool operator<(const BookMove& m) const
+    {
+        return key != m.key ? key < m.key : move < m.move;
+    }
+
+    bool operator==(const BookMove& m) const
+    {
+        return key == m.key && move == m.move;
+    }
+};
+
+/** Add the good moves of a node and its subtree to the book moves.
+    @param tree
+    @param node
+    @param boards The boards for each depth, the board at depth contains the
+    position at node.
+    @param depth
+    @param transforms
+    @param[in,out] book_moves */
+void add_book_moves(
+        const PentobiTree& tree, const SgfNode& node,
+        vector<unique_ptr<Board>>& boards, unsigned depth,
+        const vector<unique_ptr<libboardgame_base::PointTransform<Point>>>&
+        transforms, vector<BookMove>& book_moves)
+{
+    auto& bd = *boards[depth];
+    if (boards.size() <= depth + 1)
+        boards.push_back(make_unique<Board>(bd.get_variant()));
+    for (auto& child : node.get_children())
+    {
+        if (has_setup(child))
+        {
+            LIBBOARDGAME_LOG("WARNING: Ignoring book nodes with setup");
+            continue;
+        }
+        auto mv = tree.get_move(child);
+        if (mv.is_null())
+        {
+            LIBBOARDGAME_LOG("WARNING: Book contains nodes without moves");
+            continue;
+        }
+        if (! bd.is_legal(mv.color, mv.move))
+        {
+            LIBBOARDGAME_LOG("WARNING: Book contains illegal move");
+            continue;
+        }
+        if (SgfTree::get_good_move(child) > 0)
+        {
+            unsigned transform;
+            auto key = bd.get_canonical_hash(mv.color, transform);
+            auto transformed_mv =
+                    get_transformed(bd, mv.move, *transforms[transform]);
+            book_moves.push_back({key, transformed_mv.to_int()});
+        }
+        auto& child_bd = *boards[depth + 1];
+        child_bd.copy_from(bd);
+        child_bd.play(mv);
+        add_book_moves(tree, child, boards, depth + 1, transforms, book_moves);
+    }
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+CompiledBook::CompiledBook(const string& file)
+{
+    m_file = make_unique<MappedFile>(file);
+    auto data = m_file->get_data();
+    auto end = data + m_file->get_size();
+    array<char, 16> magic;
+    BookHeader header;
+    read_binary(data, end, magic);
+    read_binary(data, end, header);
+    header.variant.back() = '\0';
+    if (magic != book_magic
+            || ! parse_variant_id(header.variant.data(), m_variant)
+            || header.move_range
+               != BoardConst::get(m_variant).get_range())
+        throw runtime_error(file + ": wrong format");
+    BookLayout layout(sizeof(Entry), header);
+    if (m_file->get_size() != layout.size)
+        throw runtime_error(file + ": wrong size");
+    data = m_file->get_data();
+    m_nu_entries = header.nu_entries;
+    m_entries = reinterpret_cast<const Entry*>(data + layout.entries);
+    m_moves = reinterpret_cast<const Move::IntType*>(data + layout.moves);
+    for (size_t i = 0; i < m_nu_entries; ++i)
+        if (m_entries[i].begin + m_entries[i].nu_moves > header.nu_moves)
+            throw runtime_error(file + ": invalid entry");
+    for (size_t i = 0; i < header.nu_moves; ++i)
+        if (m_moves[i] == Move::null().to_int()
+                || m_moves[i] >= header.move_range)
+            throw runtime_error(file + ": invalid move");
+    get_transforms(m_variant, m_transforms, m_inv_transforms);
+}
+
+CompiledBook::~CompiledBook() = default;
+
+void CompiledBook::compile(const PentobiTree& tree, const string& file)
+{
+    auto variant = tree.get_variant();
+    auto& root = tree.get_root();
+    if (has_setup(root))
+        throw runtime_error("book contains setup");
+    vector<unique_ptr<PointTransform>> transforms;
+    vector<unique_ptr<PointTransform>> inv_transforms;
+    get_transforms(variant, transforms, inv_transforms);
+    vector<unique_ptr<Board>> boards;
+    boards.push_back(make_unique<Board>(variant));
+    vector<BookMove> book_moves;
+    add_book_moves(tree, root, boards, 0, transforms, book_moves);
+    // Merge the moves of transpositions and symmetric variations
+    sort(book_moves.begin(), book_moves.end());
+    book_moves.erase(unique(book_moves.begin(), book_moves.end()),
+                     book_moves.end());
+    if (book_moves.size() > numeric_limits<uint_least32_t>::max())
+        throw runtime_error("book too large");
+    vector<Entry> entries;
+    for (uint_least32_t i = 0; i < book_moves.size(); ++i)
+        if (entries.empty() || entries.back().key != book_moves[i].key)
+            entries.push_back({book_moves[i].key, i, 1});
+        else
+            ++entries.back().nu_moves;
+    BookHeader header;
+    header.variant.fill('\0');
+    auto id = to_string_id(variant);
+    memcpy(header.variant.data(), id,
+           min(strlen(id), header.variant.size() - 1));
+    header.move_range = boards[0]->get_board_const().get_range();
+    header.nu_entries = static_cast<uint_least32_t>(entries.size());
+    header.nu_moves = static_cast<uint_least32_t>(book_moves.size());
+    BookLayout layout(sizeof(Entry), header);
+    auto pad = [](ostream& out, size_t offset) {
+        while (static_cast<size_t>(out.tellp()) < offset)
+            out.put('\0');
+    };
+    // Write to a temporary file and rename it, such that a player never sees
+    // a partially written file
+    auto tmp_file = file + ".tmp" + std::to_string(random_device()());
+    ofstream out(tmp_file, ios::binary);
+    write_binary(out, book_magic);
+    write_binary(out, header);
+    pad(out, layout.entries);
+    for (auto& entry : entries)
+        write_binary(out, entry);
+    pad(out, layout.moves);
+    for (auto& m : book_moves)
+        write_binary(out, m.move);
+    out.close();
+    if (! out || std::rename(tmp_file.c_str(), file.c_str()) != 0)
+    {
+        std::remove(tmp_file.c_str());
+        throw runtime_error("could not write " + file);
+    }
+}
+
+Move CompiledBook::genmove(const Board& bd, Color c)
+{
+    get_moves(bd, c, m_good_moves);
+    if (m_good_moves.empty())
+        return Move::null();
+    LIBBOARDGAME_LOG("Book moves: ", m_good_moves.size());
+    auto nu_good_moves = static_cast<unsigned>(m_good_moves.size());
+    return m_good_moves[m_random.generate() % nu_good_moves];
+}
+
+void CompiledBook::get_moves(const Board& bd, Color c,
+                             vector<Move>& moves) const
+{
+    moves.clear();
+    if (bd.get_variant() != m_variant || bd.has_setup())
+        // Book cannot handle setup positions
+        return;
+    unsigned transform;
+    auto key = bd.get_canonical_hash(c, transform);
+    auto end = m_entries + m_nu_entries;
+    auto entry = lower_bound(m_entries, end, key,
+                             [](const Entry& e, HashKey k) {
+        return e.key < k;
+    });
+    if (entry == end || entry->key != key)
+        return;
+    auto& inv_transform = *m_inv_transforms[transform];
+    for (auto i = entry->begin; i < entry->begin + entry->nu_moves; ++i)
+    {
+        auto mv = get_transformed(bd, Move(m_moves[i]), inv_transform);
+        // Check legality in case of a hash collision
+        if (bd.is_legal(c, mv))
+            moves.push_back(mv);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
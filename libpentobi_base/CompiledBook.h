@@ -0,0 +1,95 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/CompiledBook.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_BASE_COMPILED_BOOK_H
+#define LIBPENTOBI_BASE_COMPILED_BOOK_H
+
+#include "Board.h"
+#include "PentobiTree.h"
+#include "libboardgame_base/MappedFile.h"
+#include "libboardgame_base/PointTransform.h"
+#include "libboardgame_base/RandomGenerator.h"
+
+namespace libpentobi_base {
+
+using libboardgame_base::MappedFile;
+using libboardgame_base::RandomGenerator;
+
+//-----------------------------------------------------------------------------
+
+/** Opening book compiled to a binary file.
+    A compiled book contains the same good moves as an SGF book (see Book) as
+    a table sorted by the canonical hash key of the positions (see
+    Board::get_canonical_hash()) and the color to play. The moves are stored
+    in the orientation of the canonical position. A lookup is a binary search
+    in the memory-mapped file, so the book does not need to be parsed, its
+    size does not affect the loading time and transpositions are found even
+    if the move sequence is not in the SGF tree. */
+class CompiledBook
+{
+public:
+    /** Load a compiled book.
+        @throws runtime_error If the file cannot be read or has the wrong
+        format. */
+    explicit CompiledBook(const string& file);
+
+    ~CompiledBook();
+
+    /** Compile an SGF book.
+        Nodes with setup properties are ignored.
+        @param tree The book.
+        @param file The file to write.
+        @throws runtime_error If the root node contains setup properties or
+        the file cannot be written. */
+    static void compile(const PentobiTree& tree, const string& file);
+
+    Variant get_variant() const { return m_variant; }
+
+    /** Get the number of positions with good moves. */
+    size_t get_nu_entries() const { return m_nu_entries; }
+
+    /** Get the legal good moves in a position.
+        Setup positions are not supported and never have book moves.
+        @param bd The position.
+        @param c The color to play.
+        @param[out] moves The moves in the orientation of bd. */
+    void get_moves(const Board& bd, Color c, vector<Move>& moves) const;
+
+    /** Select a random good move.
+        @return The move or Move::null() if the position is not in the
+        book. */
+    Move genmove(const Board& bd, Color c);
+
+private:
+    using PointTransform = libboardgame_base::PointTransform<Point>;
+
+    struct Entry;
+
+
+    Variant m_variant;
+
+    size_t m_nu_entries;
+
+    const Entry* m_entries;
+
+    const Move::IntType* m_moves;
+
+    unique_ptr<MappedFile> m_file;
+
+    RandomGenerator m_random;
+
+    vector<unique_ptr<PointTransform>> m_transforms;
+
+    vector<unique_ptr<PointTransform>> m_inv_transforms;
+
+    vector<Move> m_good_moves;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
+
+#endif // LIBPENTOBI_BASE_COMPILED_BOOK_H
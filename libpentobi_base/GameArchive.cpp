@@ -0,0 +1,275 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/GameArchive.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "GameArchive.h"
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include "BoardConst.h"
+#include "NodeUtil.h"
+#include "libboardgame_base/BinaryIO.h"
+
+namespace libpentobi_base {
+
+using libboardgame_base::read_binary;
+using libboardgame_base::write_binary;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Identifier at the beginning of game archive files.
+    Needs to be changed if the format changes. */
+const array<char, 16> archive_magic = {
+    'P', 'E', 'N', 'T', 'O', 'B', 'I', '-', 'G', 'A', 'M', 'E', '-', '0', '1',
+    '\n' };
+
+/** Parameters of a game archive stored after archive_magic. */
+struct ArchiveHeader
+{
+    /** Game variant as returned by to_string_id() padded with zeros. */
+    array<char, 32> variant;
+
+    /** Number of moves of the board type.
+        Used to detect archives written by a version with a different move
+        numbering. */
+    uint_least32_t move_range;
+};
+
+/** Location of the index stored at the end of the file.
+    The index is an array with the file offset of each game record. A game
+    record contains the number of moves, the result and the player names as
+    strings with their length, the moves and the colors of the moves. */
+struct ArchiveFooter
+{
+    uint_least64_t index;
+
+    uint_least64_t nu_games;
+};
+
+const size_t records_begin = sizeof(archive_magic) + sizeof(ArchiveHeader);
+
+void read_string(const char*& data, const char* end, string& s)
+{
+    uint_least16_t size;
+    read_binary(data, end, size);
+    if (static_cast<size_t>(end - data) < size)
+        throw runtime_error("unexpected end of binary data");
+    s.assign(data, size);
+    data += size;
+}
+
+void write_string(ostream& out, const string& s)
+{
+    if (s.size() > numeric_limits<uint_least16_t>::max())
+        throw runtime_error("game archive: string too long");
+    write_binary(out, static_cast<uint_least16_t>(s.size()));
+    out.write(s.data(), static_cast<streamsize>(s.size()));
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+void GameRecord::clear()
+{
+    player_names.clear();
+    result.clear();
+    moves.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void get_game_record(const PentobiTree& tree, GameRecord& record)
+{
+    record.clear();
+    auto nu_players = get_nu_players(tree.get_variant());
+    for (Color::IntType i = 0; i < nu_players; ++i)
+        record.player_names.push_back(tree.get_player_name(Color(i)));
+    auto node = &tree.get_root();
+    record.result = node->get_property("RE", "");
+    do
+    {
+        if (has_setup(*node))
+            throw runtime_error("game archive: setup not supported");
+        auto mv = tree.get_move(*node);
+        if (! mv.is_null())
+            record.moves.push_back(mv);
+        node = node->get_first_child_or_null();
+    }
+    while (node != nullptr);
+}
+
+void get_tree(Variant variant, const GameRecord& record, PentobiTree& tree)
+{
+    tree.init_variant(variant);
+    auto& root = tree.get_root();
+    for (Color::IntType i = 0; i < record.player_names.size(); ++i)
+        tree.set_player_name(Color(i), record.player_names[i]);
+    if (! record.result.empty())
+        tree.set_property(root, "RE", record.result);
+    auto node = &root;
+    for (auto& mv : record.moves)
+    {
+        node = &tree.create_new_child(*node);
+        tree.set_move(*node, mv);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+GameArchive::GameArchive(const string& file)
+{
+    m_file = make_unique<MappedFile>(file);
+    auto data = m_file->get_data();
+    auto size = m_file->get_size();
+    auto end = data + size;
+    array<char, 16> magic;
+    ArchiveHeader header;
+    read_binary(data, end, magic);
+    read_binary(data, end, header);
+    header.variant.back() = '\0';
+    if (magic != archive_magic
+            || ! parse_variant_id(header.variant.data(), m_variant)
+            || header.move_range
+               != BoardConst::get(m_variant).get_range())
+        throw runtime_error(file + ": wrong format");
+    m_nu_colors = get_nu_colors(m_variant);
+    m_move_range = header.move_range;
+    ArchiveFooter footer;
+    if (size < records_begin + sizeof(footer))
+        throw runtime_error(file + ": wrong size");
+    data = end - sizeof(footer);
+    read_binary(data, end, footer);
+    // The index must be directly followed by the footer. Compute its
+    // expected position without adding the untrusted footer values, which
+    // could overflow; the subtractions cannot wrap after the checks.
+    auto index_end = size - sizeof(footer);
+    if (footer.nu_games > index_end / sizeof(uint_least64_t))
+        throw runtime_error(file + ": wrong size");
+    auto index_size = footer.nu_games * sizeof(uint_least64_t);
+    if (footer.index < records_begin
+            || footer.index != index_end - index_size)
+        throw runtime_error(file + ": wrong size");
+    m_index = static_cast<size_t>(footer.index);
+    m_nu_games = static_cast<size_t>(footer.nu_games);
+}
+
+GameArchive::~GameArchive() = default;
+
+void GameArchive::get_game(size_t i, GameRecord& record) const
+{
+    LIBBOARDGAME_ASSERT(i < m_nu_games);
+    auto index = m_file->get_data() + m_index + i * sizeof(uint_least64_t);
+    auto index_end = index + 2 * sizeof(uint_least64_t);
+    uint_least64_t begin;
+    uint_least64_t end = m_index;
+    read_binary(index, index_end, begin);
+    if (i + 1 < m_nu_games)
+        read_binary(index, index_end, end);
+    if (begin < records_begin || begin > end || end > m_index)
+        throw runtime_error("game archive: invalid index");
+    auto data = m_file->get_data() + begin;
+    auto data_end = m_file->get_data() + end;
+    record.clear();
+    uint_least16_t nu_moves;
+    uint_least8_t nu_names;
+    read_binary(data, data_end, nu_moves);
+    read_string(data, data_end, record.result);
+    read_binary(data, data_end, nu_names);
+    record.player_names.resize(nu_names);
+    for (auto& name : record.player_names)
+        read_string(data, data_end, name);
+    if (static_cast<size_t>(data_end - data)
+            != nu_moves * (sizeof(Move::IntType) + 1))
+        throw runtime_error("game archive: invalid record");
+    auto colors = data + nu_moves * sizeof(Move::IntType);
+    for (unsigned j = 0; j < nu_moves; ++j)
+    {
+        Move::IntType mv;
+        uint_least8_t c;
+        read_binary(data, data_end, mv);
+        read_binary(colors, data_end, c);
+        if (mv == Move::null().to_int() || mv >= m_move_range
+                || c >= m_nu_colors)
+            throw runtime_error("game archive: invalid move");
+        record.moves.emplace_back(Color(c), Move(mv));
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+GameArchiveWriter::GameArchiveWriter(const string& file, Variant variant)
+    : m_variant(variant),
+      m_file(file),
+      m_tmp_file(file + ".tmp" + std::to_string(random_device()()))
+{
+    m_out.open(m_tmp_file, ios::binary);
+    if (! m_out)
+        throw runtime_error("could not write " + file);
+    ArchiveHeader header;
+    header.variant.fill('\0');
+    auto id = to_string_id(variant);
+    memcpy(header.variant.data(), id,
+           min(strlen(id), header.variant.size() - 1));
+    header.move_range = BoardConst::get(variant).get_range();
+    write_binary(m_out, archive_magic);
+    write_binary(m_out, header);
+    m_offset = records_begin;
+}
+
+GameArchiveWriter::~GameArchiveWriter()
+{
+    if (m_out.is_open())
+    {
+        m_out.close();
+        std::remove(m_tmp_file.c_str());
+    }
+}
+
+void GameArchiveWriter::add(const GameRecord& record)
+{
+    if (record.moves.size() > numeric_limits<uint_least16_t>::max()
+            || record.player_names.size()
+               > numeric_limits<uint_least8_t>::max())
+        throw runtime_error("game archive: record too large");
+    m_offsets.push_back(m_offset);
+    ostringstream out;
+    write_binary(out, static_cast<uint_least16_t>(record.moves.size()));
+    write_string(out, record.result);
+    write_binary(out, static_cast<uint_least8_t>(record.player_names.size()));
+    for (auto& name : record.player_names)
+        write_string(out, name);
+    for (auto& mv : record.moves)
+        write_binary(out, mv.move.to_int());
+    for (auto& mv : record.moves)
+        write_binary(out, static_cast<uint_least8_t>(mv.color.to_int()));
+    auto s = out.str();
+    m_out.write(s.data(), static_cast<streamsize>(s.size()));
+    m_offset += s.size();
+}
+
+void GameArchiveWriter::close()
+{
+    for (auto offset : m_offsets)
+        write_binary(m_out, offset);
+    ArchiveFooter footer;
+    footer.index = m_offset;
+    footer.nu_games = m_offsets.size();
+    write_binary(m_out, footer);
+    m_out.close();
+    if (! m_out || std::rename(m_tmp_file.c_str(), m_file.c_str()) != 0)
+    {
+        std::remove(m_tmp_file.c_str());
+        throw runtime_error("could not write " + m_file);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
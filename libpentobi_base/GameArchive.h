@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/GameArchive.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_BASE_GAME_ARCHIVE_H
+#define LIBPENTOBI_BASE_GAME_ARCHIVE_H
+
+#include <fstream>
+#include "ColorMove.h"
+#include "PentobiTree.h"
+#include "libboardgame_base/MappedFile.h"
+
+namespace libpentobi_base {
+
+using libboardgame_base::MappedFile;
+
+//-----------------------------------------------------------------------------
+
+/** Main variation of a game without the SGF tree. */
+struct GameRecord
+{
+    /** Player names, one for each player of the game variant. */
+    vector<string> player_names;
+
+    /** Value of the SGF RE property or empty if the game has no result. */
+    string result;
+
+    vector<ColorMove> moves;
+
+    void clear();
+};
+
+//-----------------------------------------------------------------------------
+
+/** Convert the main variation of a tree to a game record.
+    Nodes without moves are ignored.
+    @throws runtime_error If the main variation contains setup properties. */
+void get_game_record(const PentobiTree& tree, GameRecord& record);
+
+/** Convert a game record to a tree.
+    @param variant The game variant of the record.
+    @param record
+    @param[out] tree */
+void get_tree(Variant variant, const GameRecord& record, PentobiTree& tree);
+
+//-----------------------------------------------------------------------------
+
+/** Archive of game records in a binary file.
+    Game archives are much faster to read than files with many SGF trees
+    because they do not need to be parsed and the games do not need to be
+    built as trees. The file is memory-mapped and contains an index at the
+    end, so a game can be read without reading the previous games. All games
+    in an archive have the same game variant. The moves are stored in the
+    internal move representation of the game variant, so archives need to be
+    recreated if the move numbering of the board type changes. */
+class GameArchive
+{
+public:
+    /** Open an archive.
+        @throws runtime_error If the file cannot be read or has the wrong
+        format. */
+    explicit GameArchive(const string& file);
+
+    ~GameArchive();
+
+    Variant get_variant() const { return m_variant; }
+
+    size_t get_nu_games() const { return m_nu_games; }
+
+    /** Read a game.
+        @param i The index of the game.
+        @param[out] record
+        @throws runtime_error If the record is corrupt. */
+    void get_game(size_t i, GameRecord& record) const;
+
+private:
+    Variant m_variant;
+
+    Color::IntType m_nu_colors;
+
+    size_t m_move_range;
+
+    size_t m_nu_games;
+
+    /** Offset of the index in the file.
+        The end of the last game record. */
+    size_t m_index;
+
+    unique_ptr<MappedFile> m_file;
+};
+
+//-----------------------------------------------------------------------------
+
+/** Writes a game archive.
+    The archive is written to a temporary file, which is renamed in close(),
+    so the archive never contains partially written games. */
+class GameArchiveWriter
+{
+public:
+    /** Constructor.
+        @throws runtime_error If the file cannot be created. */
+    GameArchiveWriter(const string& file, Variant variant);
+
+    /** Destructor.
+        Discards the archive if close() was not called. */
+    ~GameArchiveWriter();
+
+    /** Add a game.
+        @throws runtime_error If the game has too many moves or a string of
+        the record is too long. */
+    void add(const GameRecord& record);
+
+    /** Write the index and rename the temporary file.
+        @throws runtime_error If the file cannot be written. */
+    void close();
+
+    size_t get_nu_games() const { return m_offsets.size(); }
+
+private:
+    Variant m_variant;
+
+    string m_file;
+
+    string m_tmp_file;
+
+    ofstream m_out;
+
+    size_t m_offset;
+
+    vector<uint_least64_t> m_offsets;
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
+
+#endif // LIBPENTOBI_BASE_GAME_ARCHIVE_H
@@ -0,0 +1,39 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/Zobrist.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "Zobrist.h"
+
+#include <random>
+
+namespace libpentobi_base {
+
+//-----------------------------------------------------------------------------
+
+Zobrist::Zobrist()
+{
+    // Don't change the seed or the order of generation, hash keys may be
+    // stored in files
+    mt19937_64 generator;
+    for (Color c : Color::Range(Color::range))
+    {
+        for (auto& key : m_point[c])
+            key = generator();
+        for (Piece::IntType i = 0; i < Piece::max_pieces; ++i)
+            for (auto& key : m_nu_left_piece[c][Piece(i)])
+                key = generator();
+        m_to_play[c] = generator();
+    }
+}
+
+const Zobrist& Zobrist::get()
+{
+    static Zobrist zobrist;
+    return zobrist;
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
@@ -0,0 +1,64 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/Zobrist.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_BASE_ZOBRIST_H
+#define LIBPENTOBI_BASE_ZOBRIST_H
+
+#include <cstdint>
+#include "ColorMap.h"
+#include "PieceInfo.h"
+#include "PieceMap.h"
+#include "Point.h"
+
+namespace libpentobi_base {
+
+//-----------------------------------------------------------------------------
+
+/** Hash key of a board position. */
+using HashKey = uint_least64_t;
+
+//-----------------------------------------------------------------------------
+
+/** Random keys for Zobrist hashing of board positions.
+    The hash key of a position is the XOR of the keys of all occupied points,
+    the number of instances left of each piece and the color to play (see
+    Board::get_hash()). The keys are generated with a fixed seed, so hash keys
+    are stable across program runs and can be stored in files. */
+class Zobrist
+{
+public:
+    static const Zobrist& get();
+
+    HashKey get_point(Color c, Point p) const { return m_point[c][p.to_int()]; }
+
+    HashKey get_nu_left_piece(Color c, Piece piece, unsigned nu_left) const;
+
+    HashKey get_to_play(Color c) const { return m_to_play[c]; }
+
+private:
+    ColorMap<array<HashKey, Point::range>> m_point;
+
+    ColorMap<PieceMap<array<HashKey, PieceInfo::max_instances + 1>>>
+    m_nu_left_piece;
+
+    ColorMap<HashKey> m_to_play;
+
+
+    Zobrist();
+};
+
+inline HashKey Zobrist::get_nu_left_piece(Color c, Piece piece,
+                                          unsigned nu_left) const
+{
+    LIBBOARDGAME_ASSERT(nu_left <= PieceInfo::max_instances);
+    return m_nu_left_piece[c][piece][nu_left];
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_base
+
+#endif // LIBPENTOBI_BASE_ZOBRIST_H
@@ -0,0 +1,45 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/tests/BitboardTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libpentobi_base/Bitboard.h"
+
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using namespace libpentobi_base;
+
+//-----------------------------------------------------------------------------
+
+LIBBOARDGAME_TEST_CASE(pentobi_base_bitboard_intersects)
+{
+    Bitboard bb;
+    bb.clear();
+    bb.set(10, 7);
+    LIBBOARDGAME_CHECK(bb.get(10, 7));
+    LIBBOARDGAME_CHECK(! bb.get(11, 7));
+    // Piece with points (0,0), (1,0), (1,1), (1,2), (1,3) relative to x, y
+    MoveBits bits{0, 0, 0x1 | 0x2 | (0x2 << 5) | (0x2 << 10) | (0x2 << 15)};
+    for (unsigned y = 0; y < 12; ++y)
+        for (unsigned x = 0; x < 14; ++x)
+        {
+            bits.x = static_cast<uint_least8_t>(x);
+            bits.y = static_cast<uint_least8_t>(y);
+            bool expected =
+                    (y == 7 && (x == 10 || x == 9))
+                    || (x == 9 && y >= 4 && y <= 6);
+            LIBBOARDGAME_CHECK_EQUAL(bb.intersects(bits), expected);
+        }
+    bits.x = 20;
+    bits.y = 20;
+    bb.set(bits);
+    LIBBOARDGAME_CHECK(bb.get(20, 20));
+    LIBBOARDGAME_CHECK(bb.get(21, 23));
+    LIBBOARDGAME_CHECK(! bb.get(20, 21));
+    LIBBOARDGAME_CHECK(! bb.get(22, 20));
+    LIBBOARDGAME_CHECK(bb.intersects(bits));
+}
+
+//-----------------------------------------------------------------------------
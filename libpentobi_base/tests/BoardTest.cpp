@@ -7,6 +7,7 @@
 #include "libpentobi_base/Board.h"
 
 #include "libboardgame_test/Test.h"
+#include "libpentobi_base/BoardUtil.h"
 #include "libpentobi_base/MoveMarker.h"
 
 using namespace std;
@@ -16,6 +17,22 @@ using namespace libpentobi_base;
 
 namespace {
 
+/** Get a string with the state of all points for comparing positions. */
+string get_points_state(const Board& bd)
+{
+    string s;
+    for (Point p : bd)
+    {
+        s += static_cast<char>('0' + bd.get_point_state(p).to_int());
+        for (Color c : bd.get_colors())
+        {
+            s += (bd.is_forbidden(p, c) ? 'F' : '-');
+            s += (bd.is_attach_point(p, c) ? 'A' : '-');
+        }
+    }
+    return s;
+}
+
 void play(Board& bd, Color c, const char* s)
 {
     Move mv;
@@ -135,6 +152,149 @@ LIBBOARDGAME_TEST_CASE(pentobi_base_board_gen_moves_classic_initial)
     LIBBOARDGAME_CHECK_EQUAL(moves->size(), 58u);
 }
 
+/** Test restore_snapshot() after a few moves (restores only the changed
+    points) and after many moves (restores the whole board). */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_restore_snapshot)
+{
+    auto bd = make_unique<Board>(Variant::classic);
+    auto moves = make_unique<MoveList>();
+    auto marker = make_unique<MoveMarker>();
+    play(*bd, Color(0), "a20,b20");
+    play(*bd, Color(1), "r20,s20,t20");
+    bd->take_snapshot();
+    auto points_state = get_points_state(*bd);
+    auto to_play = bd->get_to_play();
+    for (unsigned nu_moves : { 1, 2, 20 })
+    {
+        for (unsigned i = 0; i < nu_moves; ++i)
+        {
+            auto c = bd->get_effective_to_play();
+            bd->gen_moves(c, *marker, *moves);
+            marker->clear(*moves);
+            LIBBOARDGAME_ASSERT(! moves->empty());
+            bd->play(c, (*moves)[moves->size() / 2]);
+        }
+        bd->restore_snapshot();
+        LIBBOARDGAME_CHECK_EQUAL(bd->get_nu_moves(), 2u);
+        LIBBOARDGAME_CHECK(bd->get_to_play() == to_play);
+        LIBBOARDGAME_CHECK_EQUAL(bd->get_attach_points(Color(2)).size(), 0u);
+        LIBBOARDGAME_CHECK(get_points_state(*bd) == points_state);
+    }
+}
+
+/** Test that the forbidden bitboards agree with is_forbidden(Color, Move).
+    Only checked if the bitboards are used in this build. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_forbidden_bits)
+{
+    if constexpr (! Bitboard::is_vectorized)
+        return;
+    auto moves = make_unique<MoveList>();
+    auto marker = make_unique<MoveMarker>();
+    for (auto variant : { Variant::classic, Variant::duo, Variant::callisto })
+    {
+        auto bd = make_unique<Board>(variant);
+        auto& bc = bd->get_board_const();
+        auto move_bits = bc.get_move_bits_array();
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            auto c = bd->get_effective_to_play();
+            for (Move::IntType j = 1; j < bc.get_range(); ++j)
+            {
+                Move mv(j);
+                LIBBOARDGAME_CHECK_EQUAL(
+                            bd->get_forbidden_bits(c).intersects(move_bits[j]),
+                            bd->is_forbidden(c, mv));
+            }
+            bd->gen_moves(c, *marker, *moves);
+            marker->clear(*moves);
+            if (moves->empty())
+                break;
+            bd->play(c, (*moves)[moves->size() / 3]);
+        }
+    }
+}
+
+/** Test that the incrementally updated hash key agrees with the key computed
+    from scratch, also after restore_snapshot(). */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_hash)
+{
+    auto moves = make_unique<MoveList>();
+    auto marker = make_unique<MoveMarker>();
+    for (auto variant : { Variant::classic, Variant::duo, Variant::trigon_2,
+                          Variant::nexos, Variant::callisto_2,
+                          Variant::gembloq })
+    {
+        auto bd = make_unique<Board>(variant);
+        LIBBOARDGAME_CHECK_EQUAL(bd->get_hash(), bd->compute_hash());
+        bd->take_snapshot();
+        auto hash = bd->get_hash();
+        while (! bd->is_game_over())
+        {
+            auto c = bd->get_effective_to_play();
+            bd->gen_moves(c, *marker, *moves);
+            marker->clear(*moves);
+            bd->play(c, (*moves)[moves->size() / 3]);
+            LIBBOARDGAME_CHECK_EQUAL(bd->get_hash(), bd->compute_hash());
+        }
+        bd->restore_snapshot();
+        LIBBOARDGAME_CHECK_EQUAL(bd->get_hash(), hash);
+    }
+}
+
+/** Test that the hash key does not depend on the move order but on the
+    color to play. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_hash_transposition)
+{
+    auto bd1 = make_unique<Board>(Variant::classic_2);
+    play(*bd1, Color(0), "a20,b20");
+    play(*bd1, Color(1), "r20,s20,t20");
+    play(*bd1, Color(0), "c19");
+    auto bd2 = make_unique<Board>(Variant::classic_2);
+    play(*bd2, Color(0), "c19");
+    play(*bd2, Color(1), "r20,s20,t20");
+    play(*bd2, Color(0), "a20,b20");
+    LIBBOARDGAME_CHECK_EQUAL(bd1->get_hash(), bd2->get_hash());
+    bd2->set_to_play(Color(2));
+    LIBBOARDGAME_CHECK(bd1->get_hash() != bd2->get_hash());
+}
+
+/** Test that positions that are symmetric under the invariance
+    transformations of Duo have the same canonical hash key. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_canonical_hash)
+{
+    vector<unique_ptr<PointTransform<Point>>> transforms;
+    vector<unique_ptr<PointTransform<Point>>> inv_transforms;
+    get_transforms(Variant::duo, transforms, inv_transforms);
+    LIBBOARDGAME_CHECK_EQUAL(transforms.size(), 2u);
+    auto bd1 = make_unique<Board>(Variant::duo);
+    play(*bd1, Color(0), "e9,d10,e10,f10,e11");
+    play(*bd1, Color(1), "j5,i6,j6,k6,j7");
+    auto bd2 = make_unique<Board>(Variant::duo);
+    for (auto& mv : bd1->get_moves())
+        bd2->play(mv.color, get_transformed(*bd1, mv.move, *transforms[1]));
+    LIBBOARDGAME_CHECK(bd1->get_hash() != bd2->get_hash());
+    LIBBOARDGAME_CHECK_EQUAL(bd1->get_canonical_hash(),
+                             bd2->get_canonical_hash());
+}
+
+/** Test that the canonical hash key for a given color to play does not
+    depend on the color to play of the board. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_board_canonical_hash_to_play)
+{
+    auto bd = make_unique<Board>(Variant::duo);
+    play(*bd, Color(0), "e9,d10,e10,f10,e11");
+    play(*bd, Color(1), "j5,i6,j6,k6,j7");
+    unsigned transform0;
+    auto hash0 = bd->get_canonical_hash(Color(1), transform0);
+    bd->set_to_play(Color(1));
+    unsigned transform1;
+    auto hash1 = bd->get_canonical_hash(Color(1), transform1);
+    LIBBOARDGAME_CHECK_EQUAL(hash0, hash1);
+    LIBBOARDGAME_CHECK_EQUAL(transform0, transform1);
+    unsigned transform;
+    LIBBOARDGAME_CHECK_EQUAL(bd->get_canonical_hash(transform), hash1);
+}
+
 /** Test get_place() in a 4-color, 2-player game when the player 1 has
     a higher score but color 1 has less points than color 2. */
 LIBBOARDGAME_TEST_CASE(pentobi_base_board_get_place)
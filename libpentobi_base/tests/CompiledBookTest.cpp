@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/tests/CompiledBookTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_test/Test.h"
+#include "libpentobi_base/BoardUtil.h"
+#include "libpentobi_base/CompiledBook.h"
+
+using namespace std;
+using namespace libpentobi_base;
+using libboardgame_base::PointTransform;
+using libboardgame_base::TreeReader;
+
+//-----------------------------------------------------------------------------
+
+/** Check that the compiled book finds the good moves of an SGF book also in
+    positions transformed by the invariance transformations of the game
+    variant. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_compiled_book_duo)
+{
+    istringstream in("(;GM[Blokus Duo]"
+                     ";B[e10,f10,g10,h10,h11]TE[1]"
+                     "(;W[j5,j6,j7,k7,l7]TE[1])(;W[j5,j6,j7,j8,i8]TE[1])"
+                     "(;W[j5,k5,l5,m5]))");
+    TreeReader reader;
+    reader.read(in);
+    auto root = reader.get_tree_transfer_ownership();
+    PentobiTree tree(root);
+    string file = "pentobi_base_compiled_book_duo.blkbook";
+    CompiledBook::compile(tree, file);
+    CompiledBook book(file);
+    remove(file.c_str());
+    LIBBOARDGAME_CHECK(book.get_variant() == Variant::duo);
+    LIBBOARDGAME_CHECK_EQUAL(book.get_nu_entries(), 2u);
+    auto bd = make_unique<Board>(Variant::duo);
+    vector<Move> moves;
+    book.get_moves(*bd, Color(1), moves);
+    LIBBOARDGAME_CHECK(moves.empty());
+    book.get_moves(*bd, Color(0), moves);
+    LIBBOARDGAME_CHECK_EQUAL(moves.size(), 1u);
+    auto& first_node = tree.get_root().get_child();
+    auto first_mv = tree.get_move(first_node).move;
+    LIBBOARDGAME_CHECK(moves[0] == first_mv);
+    vector<unique_ptr<PointTransform<Point>>> transforms;
+    vector<unique_ptr<PointTransform<Point>>> inv_transforms;
+    get_transforms(Variant::duo, transforms, inv_transforms);
+    LIBBOARDGAME_CHECK_EQUAL(transforms.size(), 2u);
+    for (auto& transform : transforms)
+    {
+        bd->init();
+        bd->play(Color(0), get_transformed(*bd, first_mv, *transform));
+        book.get_moves(*bd, Color(1), moves);
+        LIBBOARDGAME_CHECK_EQUAL(moves.size(), 2u);
+        for (unsigned i = 0; i < 2; ++i)
+        {
+            auto mv = tree.get_move(first_node.get_child(i)).move;
+            mv = get_transformed(*bd, mv, *transform);
+            LIBBOARDGAME_CHECK(find(moves.begin(), moves.end(), mv)
+                               != moves.end());
+        }
+    }
+    // Same position as after the first move but created with a setup
+    Setup setup;
+    setup.to_play = Color(1);
+    setup.placements[Color(0)].push_back(first_mv);
+    bd->init(&setup);
+    book.get_moves(*bd, Color(1), moves);
+    LIBBOARDGAME_CHECK(moves.empty());
+    LIBBOARDGAME_CHECK(book.genmove(*bd, Color(1)).is_null());
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_base/tests/GameArchiveTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_test/Test.h"
+#include "libpentobi_base/GameArchive.h"
+
+using namespace std;
+using namespace libpentobi_base;
+using libboardgame_base::TreeReader;
+
+//-----------------------------------------------------------------------------
+
+/** Check that games survive the conversion from SGF to an archive and back
+    and that games can be read in any order. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_game_archive_duo)
+{
+    istringstream in("(;GM[Blokus Duo]PB[Alice]PW[Bob]RE[W+3]"
+                     ";B[e10,f10,g10,h10,h11];W[j5,j6,j7,k7,l7]"
+                     "(;B[d12,e12,f12])(;B[i12,j12]))"
+                     "(;GM[Blokus Duo];W[j5,k5,l5,m5])");
+    TreeReader reader;
+    vector<GameRecord> records;
+    bool has_more;
+    do
+    {
+        has_more = reader.read(in, false);
+        auto root = reader.get_tree_transfer_ownership();
+        PentobiTree tree(root);
+        records.emplace_back();
+        get_game_record(tree, records.back());
+    }
+    while (has_more);
+    LIBBOARDGAME_CHECK_EQUAL(records.size(), 2u);
+    LIBBOARDGAME_CHECK_EQUAL(records[0].moves.size(), 3u);
+    LIBBOARDGAME_CHECK_EQUAL(records[1].moves.size(), 1u);
+    string file = "pentobi_base_game_archive_duo.blkgames";
+    {
+        GameArchiveWriter writer(file, Variant::duo);
+        for (auto& record : records)
+            writer.add(record);
+        writer.close();
+    }
+    GameArchive archive(file);
+    remove(file.c_str());
+    LIBBOARDGAME_CHECK(archive.get_variant() == Variant::duo);
+    LIBBOARDGAME_CHECK_EQUAL(archive.get_nu_games(), 2u);
+    GameRecord record;
+    archive.get_game(1, record);
+    LIBBOARDGAME_CHECK(record.moves == records[1].moves);
+    LIBBOARDGAME_CHECK(record.result.empty());
+    archive.get_game(0, record);
+    LIBBOARDGAME_CHECK(record.moves == records[0].moves);
+    LIBBOARDGAME_CHECK_EQUAL(record.result, "W+3");
+    LIBBOARDGAME_CHECK_EQUAL(record.player_names.size(), 2u);
+    LIBBOARDGAME_CHECK_EQUAL(record.player_names[1], "Bob");
+    PentobiTree tree(Variant::duo);
+    get_tree(archive.get_variant(), record, tree);
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_player_name(Color(0)), "Alice");
+    LIBBOARDGAME_CHECK_EQUAL(tree.get_root().get_property("RE", ""), "W+3");
+    auto node = &tree.get_root();
+    for (auto& mv : records[0].moves)
+    {
+        node = &node->get_child();
+        LIBBOARDGAME_CHECK(tree.get_move(*node) == mv);
+    }
+    LIBBOARDGAME_CHECK(! node->has_children());
+}
+
+/** Check that an archive with invalid footer values is rejected, including
+    values for which the size computation would overflow. */
+LIBBOARDGAME_TEST_CASE(pentobi_base_game_archive_invalid_footer)
+{
+    string file = "pentobi_base_game_archive_invalid_footer.blkgames";
+    {
+        GameArchiveWriter writer(file, Variant::duo);
+        GameRecord record;
+        writer.add(record);
+        writer.close();
+    }
+    string data;
+    {
+        ifstream in(file, ios::binary);
+        data.assign(istreambuf_iterator<char>(in),
+                    istreambuf_iterator<char>());
+    }
+    auto check_footer = [&](uint_least64_t index, uint_least64_t nu_games) {
+        auto corrupted = data;
+        // Footer is index and number of games in native byte order
+        auto footer = &corrupted[corrupted.size() - 2 * sizeof(index)];
+        memcpy(footer, &index, sizeof(index));
+        memcpy(footer + sizeof(index), &nu_games, sizeof(nu_games));
+        {
+            ofstream out(file, ios::binary);
+            out << corrupted;
+        }
+        LIBBOARDGAME_CHECK_THROW(GameArchive archive(file), runtime_error);
+    };
+    auto max = numeric_limits<uint_least64_t>::max();
+    check_footer(max, 1);
+    check_footer(data.size(), 0);
+    check_footer(0, max / 8 + 1);
+    remove(file.c_str());
+}
+
+//-----------------------------------------------------------------------------
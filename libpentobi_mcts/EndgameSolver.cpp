@@ -0,0 +1,263 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/EndgameSolver.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "EndgameSolver.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include "libboardgame_base/Log.h"
+
+namespace libpentobi_mcts {
+
+//-----------------------------------------------------------------------------
+
+EndgameSolver::EndgameSolver(Variant initial_variant)
+    : m_is_aborted(false),
+      m_abort(false),
+      m_nu_nodes(0),
+      m_max_nodes(0),
+      m_max_time(0),
+      m_start_time(0),
+      m_time_source(nullptr),
+      m_bd(make_unique<Board>(initial_variant)),
+      m_hash(0),
+      m_best_move(Move::null()),
+      m_prior_knowledge(*m_bd)
+{
+    // Use a fixed seed, the hash keys only need to be unique within a solve
+    mt19937_64 generator;
+    for (Color c : Color::Range(Color::range))
+    {
+        for (auto& hash : m_hash_move[c])
+            hash = generator();
+        m_hash_to_play[c] = generator();
+    }
+}
+
+EndgameSolver::~EndgameSolver() = default;
+
+void EndgameSolver::abort()
+{
+    m_abort.store(true, memory_order_relaxed);
+}
+
+void EndgameSolver::clear_abort()
+{
+    m_abort.store(false, memory_order_relaxed);
+}
+
+void EndgameSolver::check_abort()
+{
+    if (m_abort.load(memory_order_relaxed)
+            || (m_max_nodes > 0 && m_nu_nodes > m_max_nodes))
+        m_is_aborted = true;
+    // Checking the time is more expensive than searching a node
+    else if (m_max_time > 0 && m_nu_nodes % 256 == 0
+             && (*m_time_source)() - m_start_time > m_max_time)
+        m_is_aborted = true;
+}
+
+void EndgameSolver::compute_gammas(const MoveList& moves)
+{
+    auto& bd = *m_bd;
+    auto max_piece_size = bd.get_board_const().get_max_piece_size();
+    if (max_piece_size == 5)
+    {
+        if (bd.is_callisto())
+            m_prior_knowledge.compute_gammas<5, 16, true>(bd, moves);
+        else
+            m_prior_knowledge.compute_gammas<5, 16, false>(bd, moves);
+    }
+    else if (max_piece_size == 6)
+        m_prior_knowledge.compute_gammas<6, 22, false>(bd, moves);
+    else if (max_piece_size == 7)
+        m_prior_knowledge.compute_gammas<7, 12, false>(bd, moves);
+    else
+    {
+        LIBBOARDGAME_ASSERT(max_piece_size == 22);
+        m_prior_knowledge.compute_gammas<22, 44, false>(bd, moves);
+    }
+    for (unsigned i = 0; i < moves.size(); ++i)
+        m_gamma[moves[i].to_int()] = m_prior_knowledge.get_gamma(i);
+}
+
+unsigned EndgameSolver::get_nu_legal_moves(const Board& bd)
+{
+    if (m_moves.empty())
+        m_moves.resize(1);
+    auto& moves = m_moves[0];
+    unsigned n = 0;
+    for (Color c : bd.get_colors())
+    {
+        bd.gen_moves(c, m_marker, moves);
+        m_marker.clear(moves);
+        n += moves.size();
+    }
+    return n;
+}
+
+ScoreType EndgameSolver::search(ScoreType alpha, ScoreType beta)
+{
+    ++m_nu_nodes;
+    check_abort();
+    if (m_is_aborted)
+        return 0;
+    auto& bd = *m_bd;
+    auto to_play = bd.get_to_play();
+    auto hash = m_hash ^ m_hash_to_play[to_play];
+    auto& entry = m_tt[hash & (tt_size - 1)];
+    auto tt_move = Move::null();
+    if (entry.hash == hash)
+    {
+        if (entry.bound == Bound::exact
+                || (entry.bound == Bound::lower && entry.value >= beta)
+                || (entry.bound == Bound::upper && entry.value <= alpha))
+            return entry.value;
+        tt_move = entry.best_move;
+    }
+    // Skip colors that have no moves left
+    auto& moves = m_moves[m_path.size()];
+    auto nu_colors = bd.get_nu_colors();
+    auto c = to_play;
+    for (Color::IntType i = 0; ; ++i)
+    {
+        if (i == nu_colors)
+        {
+            auto value = bd.get_score_twoplayer(Color(0));
+            entry.hash = hash;
+            entry.value = value;
+            entry.best_move = Move::null();
+            entry.bound = Bound::exact;
+            return value;
+        }
+        bd.gen_moves(c, m_marker, moves);
+        m_marker.clear(moves);
+        if (! moves.empty())
+            break;
+        c = c.get_next(nu_colors);
+    }
+    bd.set_to_play(c);
+    compute_gammas(moves);
+    sort(moves.begin(), moves.end(), [&](Move mv1, Move mv2) {
+        return m_gamma[mv1.to_int()] > m_gamma[mv2.to_int()];
+    });
+    if (! tt_move.is_null())
+    {
+        // The move may be illegal in case of a hash collision
+        auto i = find(moves.begin(), moves.end(), tt_move);
+        if (i != moves.end())
+            rotate(moves.begin(), i, i + 1);
+    }
+    auto alpha_orig = alpha;
+    auto beta_orig = beta;
+    bool is_max = (c.to_int() % 2 == 0);
+    auto best_value =
+            is_max ? numeric_limits<ScoreType>::lowest()
+                   : numeric_limits<ScoreType>::max();
+    auto best_move = Move::null();
+    for (Move mv : moves)
+    {
+        bd.play(c, mv);
+        m_path.emplace_back(c, mv);
+        m_hash ^= m_hash_move[c][mv.to_int()];
+        auto value = search(alpha, beta);
+        undo();
+        if (m_is_aborted)
+            return 0;
+        if (is_max)
+        {
+            if (value <= best_value)
+                continue;
+            best_value = value;
+            best_move = mv;
+            alpha = max(alpha, value);
+        }
+        else
+        {
+            if (value >= best_value)
+                continue;
+            best_value = value;
+            best_move = mv;
+            beta = min(beta, value);
+        }
+        if (alpha >= beta)
+            break;
+    }
+    // The reference entry may have been overwritten by the children
+    auto& new_entry = m_tt[hash & (tt_size - 1)];
+    new_entry.hash = hash;
+    new_entry.value = best_value;
+    new_entry.best_move = best_move;
+    if (best_value <= alpha_orig)
+        new_entry.bound = Bound::upper;
+    else if (best_value >= beta_orig)
+        new_entry.bound = Bound::lower;
+    else
+        new_entry.bound = Bound::exact;
+    if (m_path.empty())
+        m_best_move = best_move;
+    return best_value;
+}
+
+bool EndgameSolver::solve(const Board& bd, Color c, size_t max_nodes,
+                          double max_time, TimeSource& time_source,
+                          Move& mv, ScoreType& score)
+{
+    LIBBOARDGAME_ASSERT(bd.get_nu_players() == 2);
+    LIBBOARDGAME_ASSERT(bd.has_moves(c));
+    m_is_aborted = false;
+    m_nu_nodes = 0;
+    m_max_nodes = max_nodes;
+    m_max_time = max_time;
+    m_time_source = &time_source;
+    m_start_time = time_source();
+    if (m_bd->get_variant() != bd.get_variant())
+        m_bd = make_unique<Board>(bd.get_variant());
+    m_bd->copy_from(bd);
+    m_bd->set_to_play(c);
+    m_bd->take_snapshot();
+    m_prior_knowledge.start_search(bd);
+    m_path.clear();
+    m_hash = 0;
+    // Each ply plays a piece, so the depth is bounded by the pieces left
+    unsigned max_depth = 0;
+    for (Color i : bd.get_colors())
+        for (Piece piece : bd.get_pieces_left(i))
+            max_depth += bd.get_nu_left_piece(i, piece);
+    if (m_moves.size() < max_depth + 1)
+        m_moves.resize(max_depth + 1);
+    if (m_tt.empty())
+        m_tt.resize(tt_size);
+    for (auto& entry : m_tt)
+        entry.hash = 0;
+    auto value = search(numeric_limits<ScoreType>::lowest(),
+                        numeric_limits<ScoreType>::max());
+    LIBBOARDGAME_LOG("Endgame solver: ", m_nu_nodes, " nodes, ",
+                     time_source() - m_start_time, " s");
+    clear_abort();
+    if (m_is_aborted)
+        return false;
+    mv = m_best_move;
+    score = (c.to_int() % 2 == 0 ? value : -value);
+    return true;
+}
+
+void EndgameSolver::undo()
+{
+    auto mv = m_path.back();
+    m_path.pop_back();
+    m_hash ^= m_hash_move[mv.color][mv.move.to_int()];
+    // Board has no undo, replay the moves since the root position
+    auto& bd = *m_bd;
+    bd.restore_snapshot();
+    for (auto& i : m_path)
+        bd.play(i);
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
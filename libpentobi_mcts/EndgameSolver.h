@@ -0,0 +1,166 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/EndgameSolver.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_MCTS_ENDGAME_SOLVER_H
+#define LIBPENTOBI_MCTS_ENDGAME_SOLVER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "PriorKnowledge.h"
+#include "libboardgame_base/TimeSource.h"
+#include "libboardgame_mcts/TranspositionTable.h"
+#include "libpentobi_base/MoveMarker.h"
+
+namespace libpentobi_mcts {
+
+using libboardgame_base::TimeSource;
+using libboardgame_mcts::HashKey;
+using libpentobi_base::Color;
+using libpentobi_base::MoveMarker;
+using libpentobi_base::ScoreType;
+
+//-----------------------------------------------------------------------------
+
+/** Exact solver for endgame positions of two-player game variants.
+    Uses a fail-soft alpha-beta search over all legal moves until the end of
+    the game and returns the exact final score. The search is only feasible
+    if few legal moves are left, so it is aborted if it exceeds a node or
+    time budget. The values are from the view point of the first player
+    (even colors), who is the maximizing player, because the player to move
+    does not alternate if a color has to pass.
+    Moves are ordered by the move priors of PriorKnowledge, with the best move
+    from the transposition table first. */
+class EndgameSolver
+{
+public:
+    /** Number of entries in the transposition table. */
+#ifdef PENTOBI_LOW_RESOURCES
+    static constexpr size_t tt_size = (1 << 16);
+#else
+    static constexpr size_t tt_size = (1 << 20);
+#endif
+
+
+    explicit EndgameSolver(Variant initial_variant);
+
+    ~EndgameSolver();
+
+    /** Solve a position.
+        @param bd The position.
+        @param c The color to play. Must have legal moves.
+        @param max_nodes The maximum number of nodes to search (0 means no
+        limit).
+        @param max_time The maximum time in seconds (0 means no limit).
+        @param time_source
+        @param[out] mv The best move.
+        @param[out] score The exact final score from the view point of c if
+        both players play perfectly.
+        @return @c false if the search exceeded the budget or was aborted. */
+    bool solve(const Board& bd, Color c, size_t max_nodes, double max_time,
+               TimeSource& time_source, Move& mv, ScoreType& score);
+
+    /** Get the number of legal moves of all colors in a position.
+        Can be used as a cheap estimate whether a solve() is feasible. */
+    unsigned get_nu_legal_moves(const Board& bd);
+
+    /** Abort the current solve().
+        Can be called from a different thread. If no solve() is running, the
+        next solve() is aborted, such that an abort that arrives just before
+        solve() is called is not lost. The abort is cleared when solve()
+        returns or with clear_abort(). */
+    void abort();
+
+    /** Clear an abort that did not affect any solve().
+        Should be called before the task that may call solve() is started,
+        such that an abort of an earlier task does not abort solve(). */
+    void clear_abort();
+
+    /** Get the number of nodes searched in the last solve(). */
+    size_t get_nu_nodes() const { return m_nu_nodes; }
+
+private:
+    enum class Bound : unsigned char
+    {
+        exact,
+
+        lower,
+
+        upper
+    };
+
+    struct TTEntry
+    {
+        HashKey hash;
+
+        ScoreType value;
+
+        Move best_move;
+
+        Bound bound;
+    };
+
+
+    bool m_is_aborted;
+
+    atomic<bool> m_abort;
+
+    size_t m_nu_nodes;
+
+    size_t m_max_nodes;
+
+    double m_max_time;
+
+    double m_start_time;
+
+    TimeSource* m_time_source;
+
+    unique_ptr<Board> m_bd;
+
+    HashKey m_hash;
+
+    /** Best move at the root position found by search(). */
+    Move m_best_move;
+
+    PriorKnowledge m_prior_knowledge;
+
+    MoveMarker m_marker;
+
+    /** Random values for the hash key of a move played by a color. */
+    ColorMap<array<HashKey, Move::range>> m_hash_move;
+
+    /** Random values for the hash key of the color to play. */
+    ColorMap<HashKey> m_hash_to_play;
+
+    /** Move priors of the moves in the current node for sorting. */
+    array<Float, Move::range> m_gamma;
+
+    /** Moves played since the root position. */
+    vector<ColorMove> m_path;
+
+    /** Legal moves per ply. */
+    vector<MoveList> m_moves;
+
+    vector<TTEntry> m_tt;
+
+
+    void check_abort();
+
+    void compute_gammas(const MoveList& moves);
+
+    /** Search the current position.
+        @return The value from the view point of the first player. */
+    ScoreType search(ScoreType alpha, ScoreType beta);
+
+    /** Undo the last move in m_path. */
+    void undo();
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
+
+#endif // LIBPENTOBI_MCTS_ENDGAME_SOLVER_H
@@ -6,11 +6,15 @@
 
 #include "History.h"
 
+#include "libboardgame_base/BinaryIO.h"
 #include "libpentobi_base/BoardUtil.h"
 
 namespace libpentobi_mcts {
 
 using namespace std;
+using libboardgame_base::read_binary;
+using libboardgame_base::write_binary;
+using libpentobi_base::BoardConst;
 using libpentobi_base::get_current_position_as_setup;
 
 //----------------------------------------------------------------------------
@@ -68,6 +72,63 @@ bool History::is_followup(
     return true;
 }
 
+void History::read(const char*& data, const char* end)
+{
+    clear();
+    // The game variant is stored as a string, such that the data stays valid
+    // if new game variants are added
+    uint8_t len;
+    read_binary(data, end, len);
+    if (static_cast<size_t>(end - data) < len)
+        throw runtime_error("invalid history data");
+    string variant_id(data, len);
+    data += len;
+    Variant variant;
+    if (! parse_variant_id(variant_id, variant))
+        throw runtime_error("invalid history data");
+    auto& bc = BoardConst::get(variant);
+    uint8_t nu_colors;
+    uint8_t to_play;
+    uint16_t nu_moves;
+    read_binary(data, end, nu_colors);
+    read_binary(data, end, to_play);
+    read_binary(data, end, nu_moves);
+    if (nu_colors == 0 || nu_colors > Color::range || to_play >= nu_colors
+            || nu_moves > Board::max_moves)
+        throw runtime_error("invalid history data");
+    m_moves.clear();
+    for (unsigned i = 0; i < nu_moves; ++i)
+    {
+        uint8_t c;
+        Move::IntType mv;
+        read_binary(data, end, c);
+        read_binary(data, end, mv);
+        if (c >= nu_colors || mv >= bc.get_range())
+            throw runtime_error("invalid history data");
+        m_moves.push_back(ColorMove(Color(c), Move(mv)));
+    }
+    m_variant = variant;
+    m_nu_colors = nu_colors;
+    m_to_play = Color(to_play);
+    m_is_valid = true;
+}
+
+void History::write(ostream& out) const
+{
+    LIBBOARDGAME_ASSERT(is_valid());
+    string variant_id = to_string_id(m_variant);
+    write_binary(out, static_cast<uint8_t>(variant_id.size()));
+    out.write(variant_id.data(), static_cast<streamsize>(variant_id.size()));
+    write_binary(out, static_cast<uint8_t>(m_nu_colors));
+    write_binary(out, static_cast<uint8_t>(m_to_play.to_int()));
+    write_binary(out, static_cast<uint16_t>(m_moves.size()));
+    for (auto& mv : m_moves)
+    {
+        write_binary(out, static_cast<uint8_t>(mv.color.to_int()));
+        write_binary(out, mv.move.to_int());
+    }
+}
+
 //----------------------------------------------------------------------------
 
 } // namespace libpentobi_mcts
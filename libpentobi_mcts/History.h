@@ -7,11 +7,13 @@
 #ifndef LIBPENTOBI_MCTS_HISTORY_H
 #define LIBPENTOBI_MCTS_HISTORY_H
 
+#include <iosfwd>
 #include "SearchParamConst.h"
 #include "libpentobi_base/Board.h"
 
 namespace libpentobi_mcts {
 
+using namespace std;
 using libboardgame_base::ArrayList;
 using libpentobi_base::Board;
 using libpentobi_base::Color;
@@ -65,6 +67,19 @@ public:
 
     Color get_to_play() const;
 
+    Variant get_variant() const;
+
+    /** Write the state in a binary format.
+        @pre is_valid()
+        @see libboardgame_base/BinaryIO.h */
+    void write(ostream& out) const;
+
+    /** Read the state in the binary format written by write().
+        @param[in,out] data The current position in the data.
+        @param end The end of the data.
+        @throws runtime_error If the data is invalid. */
+    void read(const char*& data, const char* end);
+
 private:
     bool m_is_valid;
 
@@ -93,6 +108,12 @@ inline Color History::get_to_play() const
     return m_to_play;
 }
 
+inline Variant History::get_variant() const
+{
+    LIBBOARDGAME_ASSERT(m_is_valid);
+    return m_variant;
+}
+
 inline bool History::is_valid() const
 {
     return m_is_valid;
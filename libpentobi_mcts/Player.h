@@ -7,15 +7,20 @@
 #ifndef LIBPENTOBI_MCTS_PLAYER_H
 #define LIBPENTOBI_MCTS_PLAYER_H
 
+#include <atomic>
+#include <thread>
+#include "EndgameSolver.h"
 #include "Search.h"
 #include "libboardgame_base/Rating.h"
 #include "libpentobi_base/Book.h"
+#include "libpentobi_base/CompiledBook.h"
 #include "libpentobi_base/PlayerBase.h"
 
 namespace libpentobi_mcts {
 
 using libboardgame_base::Rating;
 using libpentobi_base::Book;
+using libpentobi_base::CompiledBook;
 using libpentobi_base::PlayerBase;
 using libpentobi_base::Variant;
 
@@ -34,10 +39,18 @@ public:
         @param max_level The maximum level used
         @param books_dir Directory containing opening books.
         @param nu_threads The number of threads to use in the search (0 means
-        to select a reasonable default value) */
+        to select a reasonable default value)
+        @param max_memory If not zero, limits the memory used for the search
+        trees, which is otherwise chosen depending on max_level and the
+        available memory. Useful if several players run in the same
+        process. */
     Player(Variant initial_variant, unsigned max_level, const string& books_dir,
-           unsigned nu_threads = 0);
+           unsigned nu_threads = 0, size_t max_memory = 0);
 
+    ~Player() override;
+
+    /** Generate a move.
+        Stops pondering first, if pondering was started. */
     Move genmove(const Board& bd, Color c) override;
 
     bool resign() const override;
@@ -61,6 +74,15 @@ public:
 
     void set_use_book(bool enable);
 
+    bool get_use_endgame_solver() const;
+
+    /** Use the exact endgame solver in genmove().
+        If enabled, genmove() tries to solve positions of two-player game
+        variants with few legal moves left (only at higher playing levels or
+        if a fixed time is used) and falls back to the search if the solver
+        exceeds its budget. */
+    void set_use_endgame_solver(bool enable);
+
     unsigned get_level() const;
 
     void set_level(unsigned level);
@@ -68,10 +90,24 @@ public:
     /** Use CPU time instead of Wall time to measure time. */
     void use_cpu_time(bool enable);
 
+    /** Set a callback function that informs the caller about the
+        estimated time left during a search.
+        See SearchBase::set_callback(). The callback function of the search
+        must not be set directly because the player uses it for stopping
+        pondering. */
+    void set_callback(const function<void(double, double)>& callback);
+
     Search& get_search();
 
+    EndgameSolver& get_endgame_solver();
+
     void load_book(istream& in);
 
+    /** Load a compiled book (see CompiledBook).
+        @throws runtime_error If the file cannot be read or has the wrong
+        format. */
+    void load_compiled_book(const string& file);
+
     /** Is a book loaded and compatible with a given game variant? */
     bool is_book_loaded(Variant variant) const;
 
@@ -96,11 +132,30 @@ public:
     /** Was last move generation based on an aborted search? */
     bool was_aborted() const { return m_was_aborted; }
 
+    /** Start searching a position in the background.
+        The search runs without limits in a separate thread until
+        stop_ponder() or genmove() is called. The search tree is reused by
+        the next genmove() if the position is the same or a follow-up
+        position (see Search::check_followup()). The search may not be
+        accessed with get_search() while pondering.
+        @param bd The position. Copied, the argument does not need to stay
+        valid while pondering.
+        @param c The color to play. */
+    void start_ponder(const Board& bd, Color c);
+
+    /** Stop pondering and wait until the search has finished.
+        Does nothing if not pondering. */
+    void stop_ponder();
+
+    bool is_pondering() const { return m_ponder_thread.joinable(); }
+
 private:
     bool m_is_book_loaded;
 
     bool m_use_book;
 
+    bool m_use_endgame_solver;
+
     bool m_resign;
 
     bool m_was_aborted;
@@ -127,16 +182,43 @@ private:
 
     Search m_search;
 
+    EndgameSolver m_endgame_solver;
+
     Book m_book;
 
+    /** Compiled book, used instead of m_book if not null. */
+    unique_ptr<CompiledBook> m_compiled_book;
+
     unique_ptr<TimeSource> m_time_source;
 
+    /** Copy of the position used while pondering. */
+    unique_ptr<Board> m_ponder_board;
+
+    thread m_ponder_thread;
+
+    /** Set by stop_ponder() to stop the pondering thread. */
+    atomic<bool> m_stop_ponder;
+
+    function<void(double, double)> m_callback;
+
 
     void init_settings();
 
     bool load_book(const string& filepath);
+
+    /** Load the book for a game variant from the books directory.
+        Prefers a compiled book (extension .blkbook) to an SGF book, because
+        it is loaded faster and does not need to be parsed. */
+    void load_book(Variant variant);
+
+    bool solve_endgame(const Board& bd, Color c, unsigned level, Move& mv);
 };
 
+inline EndgameSolver& Player::get_endgame_solver()
+{
+    return m_endgame_solver;
+}
+
 inline Float Player::get_fixed_simulations() const
 {
     return m_fixed_simulations;
@@ -167,6 +249,11 @@ inline bool Player::get_use_book() const
     return m_use_book;
 }
 
+inline bool Player::get_use_endgame_solver() const
+{
+    return m_use_endgame_solver;
+}
+
 inline void Player::set_fixed_simulations(Float n)
 {
     m_fixed_simulations = n;
@@ -191,6 +278,11 @@ inline void Player::set_use_book(bool enable)
     m_use_book = enable;
 }
 
+inline void Player::set_use_endgame_solver(bool enable)
+{
+    m_use_endgame_solver = enable;
+}
+
 //-----------------------------------------------------------------------------
 
 } // namespace libpentobi_mcts
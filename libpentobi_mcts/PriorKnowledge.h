@@ -43,7 +43,8 @@ class PriorKnowledge
 {
 public:
     using Node =
-        libboardgame_mcts::Node<Move, Float, SearchParamConst::multithread>;
+        libboardgame_mcts::Node<Move, Float, SearchParamConst::multithread,
+                                SearchParamConst::compact_node>;
 
     using Tree = libboardgame_mcts::Tree<Node>;
 
@@ -59,6 +60,22 @@ public:
                       bool is_symmetry_broken, Tree::NodeExpander& expander,
                       Float root_val);
 
+    /** Compute the move priors of a list of moves without pruning.
+        Used for move ordering outside the search tree (see EndgameSolver).
+        The color to play of the board must be the color of the moves.
+        The priors can be queried with get_gamma() until the next call. */
+    template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
+    void compute_gammas(const Board& bd, const MoveList& moves);
+
+    /** Get the unnormalized prior of the i'th move of the last
+        compute_gammas(). */
+    Float get_gamma(unsigned i) const { return m_features[i].gamma; }
+
+    /** Check if gen_children() might prune some of the moves.
+        Conservative check, may also return true if no moves would be
+        pruned. */
+    bool may_prune(const Board& bd, bool is_symmetry_broken) const;
+
 private:
     struct MoveFeatures
     {
@@ -341,6 +358,26 @@ void PriorKnowledge::compute_features(const Board& bd, const MoveList& moves,
     }
 }
 
+template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
+void PriorKnowledge::compute_gammas(const Board& bd, const MoveList& moves)
+{
+    m_local_points.init<MAX_SIZE, MAX_ADJ_ATTACH>(bd);
+    compute_features<MAX_SIZE, MAX_ADJ_ATTACH, IS_CALLISTO>(
+                bd, moves, false, false);
+}
+
+inline bool PriorKnowledge::may_prune(const Board& bd,
+                                      bool is_symmetry_broken) const
+{
+    // Must be consistent with the conditions for pruning in gen_children()
+    auto nu_onboard_pieces = bd.get_nu_onboard_pieces();
+    return (m_check_dist_to_center[bd.get_to_play()]
+            && nu_onboard_pieces <= m_dist_to_center_max_pieces)
+            || (bd.get_variant() == Variant::classic_2
+                && nu_onboard_pieces < 14)
+            || ! is_symmetry_broken;
+}
+
 template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
 bool PriorKnowledge::gen_children(const Board& bd, const MoveList& moves,
                                   bool is_symmetry_broken,
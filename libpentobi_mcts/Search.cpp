@@ -6,10 +6,29 @@
 
 #include "Search.h"
 
+#include <fstream>
 #include "Util.h"
+#include "libboardgame_base/BinaryIO.h"
+#include "libboardgame_base/MappedFile.h"
 
 namespace libpentobi_mcts {
 
+using libboardgame_base::MappedFile;
+using libboardgame_base::read_binary;
+using libboardgame_base::write_binary;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Identifier at the beginning of files written by Search::save_snapshot().
+    Needs to be changed if the format changes. */
+const array<char, 16> snapshot_magic = {
+    'P', 'E', 'N', 'T', 'O', 'B', 'I', '-', 'T', 'R', 'E', 'E', '-', '0', '2',
+    '\n' };
+
+} // namespace
+
 //-----------------------------------------------------------------------------
 
 Search::Search(Variant initial_variant, unsigned nu_threads, size_t memory)
@@ -18,6 +37,7 @@ Search::Search(Variant initial_variant, unsigned nu_threads, size_t memory)
       m_shared_const(m_to_play)
 {
     set_default_param(m_variant);
+    set_use_solver(true);
     create_threads();
 }
 
@@ -54,6 +74,45 @@ void Search::get_root_position(Variant& variant, Setup& setup) const
     setup.to_play = m_to_play;
 }
 
+bool Search::is_same_side(PlayerInt player1, PlayerInt player2) const
+{
+    // Used only in game variants with two players, in which the first player
+    // plays the colors with even index
+    return player1 % 2 == player2 % 2;
+}
+
+bool Search::is_solver_supported() const
+{
+    // Not in Callisto because the search does not generate all useless
+    // one-piece moves (see search()), so the terminal positions in the tree
+    // are not always the end of the game.
+    auto& bd = get_board();
+    return bd.get_nu_players() == 2
+            && bd.get_piece_set() != PieceSet::callisto;
+}
+
+void Search::load_snapshot(const string& file)
+{
+    MappedFile mapped_file(file);
+    auto data = mapped_file.get_data();
+    auto end = data + mapped_file.get_size();
+    array<char, 16> magic;
+    if (static_cast<size_t>(end - data) < magic.size())
+        throw runtime_error(file + " is not a Pentobi search tree");
+    read_binary(data, end, magic);
+    if (magic != snapshot_magic)
+        throw runtime_error(file + " is not a Pentobi search tree");
+    History history;
+    history.read(data, end);
+    // Avoid reusing the old tree if loading the new tree fails
+    m_last_history.clear();
+    auto range = BoardConst::get(history.get_variant()).get_range();
+    load_tree(data, end, [range](Move mv) {
+        return mv.to_int() < range;
+    });
+    m_last_history = history;
+}
+
 void Search::on_start_search(bool is_followup)
 {
     m_shared_const.init(is_followup);
@@ -93,6 +152,19 @@ bool Search::search(Move& mv, const Board& bd, Color to_play,
     return result;
 }
 
+void Search::save_snapshot(const string& file) const
+{
+    if (! m_last_history.is_valid())
+        throw runtime_error("no search tree");
+    ofstream out(file, ios::binary);
+    write_binary(out, snapshot_magic);
+    m_last_history.write(out);
+    save_tree(out);
+    out.close();
+    if (! out)
+        throw runtime_error("could not write " + file);
+}
+
 void Search::set_default_param(Variant variant)
 {
     LIBBOARDGAME_LOG("Setting default parameters for ", to_string(variant));
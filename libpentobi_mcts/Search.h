@@ -55,6 +55,10 @@ public:
 
     string get_info() const override;
 
+    bool is_solver_supported() const override;
+
+    bool is_same_side(PlayerInt player1, PlayerInt player2) const override;
+
 
     /** @name Parameters */
     /** @{ */
@@ -80,6 +84,21 @@ public:
         @param[out] setup */
     void get_root_position(Variant& variant, Setup& setup) const;
 
+    /** Save the search tree of the last search to a file.
+        The file contains the position of the last search, such that a later
+        search after load_snapshot() reuses the tree only in the same
+        position or a follow-up position. The file uses a binary format that
+        is only valid on the same machine and for the same version of Pentobi.
+        @throws runtime_error If there is no search tree or the file cannot be
+        written. */
+    void save_snapshot(const string& file) const;
+
+    /** Restore the search tree from a file written by save_snapshot().
+        The file is memory-mapped, so only the parts of the file that are
+        needed are read.
+        @throws runtime_error If the file cannot be read or is not valid. */
+    void load_snapshot(const string& file);
+
 protected:
     void on_start_search(bool is_followup) override;
 
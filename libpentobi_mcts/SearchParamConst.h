@@ -47,6 +47,12 @@ struct SearchParamConst
     static constexpr bool multithread = true;
 #endif
 
+#ifdef LIBPENTOBI_MCTS_COMPACT_NODE
+    static constexpr bool compact_node = true;
+#else
+    static constexpr bool compact_node = false;
+#endif
+
     static constexpr bool rave = true;
 
     static constexpr bool rave_dist_weighting = true;
@@ -59,6 +65,18 @@ struct SearchParamConst
     static constexpr size_t lgr_hash_table_size = (1 << 21);
 #endif
 
+#ifdef PENTOBI_LOW_RESOURCES
+    static constexpr bool use_transposition_table = false;
+
+    static constexpr size_t transposition_table_size = 0;
+#else
+    static constexpr bool use_transposition_table = true;
+
+    static constexpr size_t transposition_table_size = (1 << 20);
+#endif
+
+    static constexpr bool use_solver = true;
+
     static constexpr bool virtual_loss = true;
 
     static constexpr Float child_min_count = 3;
@@ -69,6 +87,11 @@ struct SearchParamConst
 
     static constexpr Float prune_count_start = 16;
 
+    /** Measured with benchmark-tool select_child, 16 was faster than 8
+        and than the scalar selection, even without AVX-512 (the compiler
+        unrolls the computation to several vector instructions). */
+    static constexpr unsigned select_child_block_size = 16;
+
     static constexpr Float expansion_threshold = 1;
 
     static constexpr Float expansion_threshold_inc = 0.5f;
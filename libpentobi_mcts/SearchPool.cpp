@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/SearchPool.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "SearchPool.h"
+
+#include "Util.h"
+
+namespace libpentobi_mcts {
+
+//-----------------------------------------------------------------------------
+
+SearchPool::SearchPool(Variant initial_variant, unsigned nu_threads,
+                       size_t memory)
+    : m_nu_threads(nu_threads == 0 ? get_nu_threads() : nu_threads)
+{
+    LIBBOARDGAME_LOG("Creating search pool with ", m_nu_threads, " threads");
+    m_workers.reserve(m_nu_threads);
+    for (unsigned i = 0; i < m_nu_threads; ++i)
+    {
+        auto worker = make_unique<Worker>();
+        worker->search = make_unique<Search>(initial_variant, 1,
+                                             memory / m_nu_threads);
+        // SearchBase::search() resets the abort flag when it starts, so an
+        // abort by the destructor is lost if the worker has taken a request
+        // but not yet started the search. The callback is called
+        // periodically during the search and repeats the abort in this case.
+        auto& search = *worker->search;
+        search.set_callback([this, &search](double, double) {
+            if (m_quit.load(memory_order_relaxed))
+                search.abort();
+        });
+        m_workers.push_back(move(worker));
+    }
+    for (auto& worker : m_workers)
+        worker->t = thread(&SearchPool::worker_loop, this, ref(*worker));
+}
+
+SearchPool::~SearchPool()
+{
+    {
+        lock_guard lock(m_mutex);
+        m_quit = true;
+        m_nu_pending -= static_cast<unsigned>(m_queue.size());
+        m_queue.clear();
+        for (auto& worker : m_workers)
+            if (worker->is_searching)
+                worker->search->abort();
+    }
+    m_request_cond.notify_all();
+    m_finished_cond.notify_all();
+    for (auto& worker : m_workers)
+        worker->t.join();
+}
+
+void SearchPool::submit(const Board& bd, Color to_play, Float max_count,
+                        double max_time, Callback callback)
+{
+    Request request;
+    request.bd = make_unique<Board>(bd.get_variant());
+    request.bd->copy_from(bd);
+    request.to_play = to_play;
+    request.max_count = max_count;
+    request.max_time = max_time;
+    request.callback = move(callback);
+    {
+        lock_guard lock(m_mutex);
+        m_queue.push_back(move(request));
+        ++m_nu_pending;
+    }
+    m_request_cond.notify_one();
+}
+
+void SearchPool::wait()
+{
+    unique_lock lock(m_mutex);
+    m_finished_cond.wait(lock, [&]{ return m_nu_pending == 0; });
+}
+
+void SearchPool::worker_loop(Worker& worker)
+{
+    auto& search = *worker.search;
+    while (true)
+    {
+        Request request;
+        {
+            unique_lock lock(m_mutex);
+            m_request_cond.wait(lock,
+                                [&]{ return m_quit || ! m_queue.empty(); });
+            if (m_quit)
+                break;
+            request = move(m_queue.front());
+            m_queue.pop_front();
+            worker.is_searching = true;
+        }
+        Result result;
+        result.mv = Move::null();
+        search.search(result.mv, *request.bd, request.to_play,
+                      request.max_count, 0, request.max_time,
+                      worker.time_source);
+        result.value = search.get_root_val().get_mean();
+        result.nu_simulations = search.get_nu_simulations();
+        result.was_aborted = search.was_aborted();
+        request.callback(result);
+        {
+            lock_guard lock(m_mutex);
+            worker.is_searching = false;
+            --m_nu_pending;
+        }
+        m_finished_cond.notify_all();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
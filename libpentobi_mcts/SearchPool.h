@@ -0,0 +1,144 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/SearchPool.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef LIBPENTOBI_MCTS_SEARCH_POOL_H
+#define LIBPENTOBI_MCTS_SEARCH_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "Search.h"
+#include "libboardgame_base/WallTimeSource.h"
+
+namespace libpentobi_mcts {
+
+using namespace std;
+using libboardgame_base::WallTimeSource;
+
+//-----------------------------------------------------------------------------
+
+/** Searches many independent positions with a fixed number of threads and
+    a fixed amount of memory.
+    This can be used to serve many games from a single process. Instead of
+    one multi-threaded Search per game, the pool owns one single-threaded
+    Search per worker thread and the memory is divided between them.
+    Requests are handled in the order they were submitted by the next free
+    worker. Since a worker keeps its search tree between requests, the tree
+    is reused if a worker happens to search a follow-up position of its
+    previous request, but there is no affinity between games and workers. */
+class SearchPool
+{
+public:
+    struct Result
+    {
+        /** The best move or Move::null() if there are no legal moves. */
+        Move mv;
+
+        /** Estimated value of the position from the view point of the color
+            to play. */
+        Float value;
+
+        size_t nu_simulations;
+
+        bool was_aborted;
+    };
+
+    /** Function called by the worker thread after a search has finished.
+        The callback is called without holding a lock, so it may submit new
+        requests. It must not throw. */
+    using Callback = function<void(const Result&)>;
+
+
+    /** Constructor.
+        @param initial_variant Game variant to initialize the searches with.
+        (Requests can use a different game variant.)
+        @param nu_threads The number of worker threads (0 means to use the
+        number of hardware threads)
+        @param memory The total memory for the search trees of all workers. */
+    SearchPool(Variant initial_variant, unsigned nu_threads, size_t memory);
+
+    /** Destructor.
+        Aborts running searches and waits for the workers to finish.
+        Requests that were not started yet are discarded and their callbacks
+        are not called. */
+    ~SearchPool();
+
+    unsigned get_nu_threads() const { return m_nu_threads; }
+
+    /** Queue a search request.
+        @param bd The position. Copied, the argument does not need to stay
+        valid until the search is finished.
+        @param to_play The color to play.
+        @param max_count The number of simulations (0 means no limit).
+        @param max_time The maximum search time in seconds. Only used if
+        max_count is zero.
+        @param callback Called with the result of the search. */
+    void submit(const Board& bd, Color to_play, Float max_count,
+                double max_time, Callback callback);
+
+    /** Wait until all submitted requests are finished. */
+    void wait();
+
+private:
+    struct Request
+    {
+        unique_ptr<Board> bd;
+
+        Color to_play;
+
+        Float max_count;
+
+        double max_time;
+
+        Callback callback;
+    };
+
+    struct Worker
+    {
+        unique_ptr<Search> search;
+
+        WallTimeSource time_source;
+
+        /** Whether the worker has taken a request and not yet finished it.
+            Protected by m_mutex. */
+        bool is_searching = false;
+
+        thread t;
+    };
+
+
+    unsigned m_nu_threads;
+
+    /** Set by the destructor.
+        Written while holding m_mutex, but also read by the workers during
+        their searches without holding it. */
+    atomic<bool> m_quit{false};
+
+    /** Number of requests that are queued or running. */
+    unsigned m_nu_pending = 0;
+
+    deque<Request> m_queue;
+
+    vector<unique_ptr<Worker>> m_workers;
+
+    mutex m_mutex;
+
+    condition_variable m_request_cond;
+
+    condition_variable m_finished_cond;
+
+
+    void worker_loop(Worker& worker);
+};
+
+//-----------------------------------------------------------------------------
+
+} // namespace libpentobi_mcts
+
+#endif // LIBPENTOBI_MCTS_SEARCH_POOL_H
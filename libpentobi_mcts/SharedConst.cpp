@@ -6,6 +6,8 @@
 
 #include "SharedConst.h"
 
+#include <random>
+
 namespace libpentobi_mcts {
 
 using libpentobi_base::BoardConst;
@@ -200,7 +202,17 @@ SharedConst::SharedConst(const Color& to_play)
     : board(nullptr),
       to_play(to_play),
       avoid_symmetric_draw(true)
-{ }
+{
+    // Use a fixed seed, the hash keys only need to be unique within a
+    // search and all threads need to use the same values
+    mt19937_64 generator;
+    for (Color c : Color::Range(Color::range))
+    {
+        for (auto& hash : hash_move[c])
+            hash = generator();
+        hash_to_play[c] = generator();
+    }
+}
 
 void SharedConst::init(bool is_followup)
 {
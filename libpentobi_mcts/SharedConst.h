@@ -7,6 +7,7 @@
 #ifndef LIBPENTOBI_MCTS_SHARED_CONST_H
 #define LIBPENTOBI_MCTS_SHARED_CONST_H
 
+#include "libboardgame_mcts/TranspositionTable.h"
 #include "libpentobi_base/Board.h"
 #include "libpentobi_base/MoveMarker.h"
 
@@ -14,6 +15,7 @@ namespace libpentobi_mcts {
 
 using namespace std;
 using libboardgame_base::ArrayList;
+using libboardgame_mcts::HashKey;
 using libpentobi_base::Board;
 using libpentobi_base::Color;
 using libpentobi_base::ColorMap;
@@ -72,6 +74,13 @@ public:
     /** Moves corresponding to one_piece_points_callisto. */
     ArrayList<Move, Point::range_onboard> one_piece_moves_callisto;
 
+    /** Random values for the hash key of a move played by a color.
+        See State::get_hash(). */
+    ColorMap<array<HashKey, Move::range>> hash_move;
+
+    /** Random values for the hash key of the color to play. */
+    ColorMap<HashKey> hash_to_play;
+
 
     explicit SharedConst(const Color& to_play);
 
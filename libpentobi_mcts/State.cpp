@@ -105,6 +105,7 @@ void State::add_starting_moves(Color c, const Board::PiecesLeftList& pieces,
     unsigned nu_moves = 0;
     auto& marker = m_marker[c];
     auto& is_forbidden = m_bd.is_forbidden(c);
+    auto& forbidden_bits = m_bd.get_forbidden_bits(c);
     float total_gamma = 0;
     bool is_gembloq = (m_bd.get_piece_set() == PieceSet::gembloq);
     for (Piece piece : pieces)
@@ -114,7 +115,8 @@ void State::add_starting_moves(Color c, const Board::PiecesLeftList& pieces,
             // (=quarter-square tringle) are legal.
             if (is_gembloq && ! m_bd.is_legal(c, mv))
                 continue;
-            if (check_forbidden<MAX_SIZE>(is_forbidden, mv, moves, nu_moves))
+            if (check_forbidden<MAX_SIZE>(is_forbidden, forbidden_bits, mv,
+                                          moves, nu_moves))
             {
                 LIBBOARDGAME_ASSERT(! marker[mv]);
                 marker.set(mv);
@@ -129,20 +131,31 @@ void State::add_starting_moves(Color c, const Board::PiecesLeftList& pieces,
 }
 
 template<unsigned MAX_SIZE>
-bool State::check_forbidden(const GridExt<bool>& is_forbidden, Move mv,
-                            MoveList& moves, unsigned& nu_moves)
+bool State::check_forbidden(
+        [[maybe_unused]] const GridExt<bool>& is_forbidden,
+        [[maybe_unused]] const Bitboard& forbidden_bits, Move mv,
+        MoveList& moves, unsigned& nu_moves)
 {
-    auto p = get_move_info<MAX_SIZE>(mv).begin();
-    unsigned forbidden = is_forbidden[*p];
-    for (unsigned i = 1; i < MAX_SIZE; ++i)
-        // Logically, forbidden is a bool and the next line should be
-        //   forbidden = forbidden || is_forbidden[*(++p)]
-        // But this generates branches, which are bad for performance in this
-        // tight loop (unrolled by the compiler). So we use a bitwise OR, which
-        // works because C++ guarantees that true/false converts to 1/0.
-        forbidden |= static_cast<unsigned>(is_forbidden[*(++p)]);
-    if (forbidden != 0)
-        return false;
+    if constexpr (MAX_SIZE == 5 && Bitboard::is_vectorized)
+    {
+        if (forbidden_bits.intersects(m_move_bits_array[mv.to_int()]))
+            return false;
+    }
+    else
+    {
+        auto p = get_move_info<MAX_SIZE>(mv).begin();
+        unsigned forbidden = is_forbidden[*p];
+        for (unsigned i = 1; i < MAX_SIZE; ++i)
+            // Logically, forbidden is a bool and the next line should be
+            //   forbidden = forbidden || is_forbidden[*(++p)]
+            // But this generates branches, which are bad for performance in
+            // this tight loop (unrolled by the compiler). So we use a bitwise
+            // OR, which works because C++ guarantees that true/false converts
+            // to 1/0.
+            forbidden |= static_cast<unsigned>(is_forbidden[*(++p)]);
+        if (forbidden != 0)
+            return false;
+    }
     LIBBOARDGAME_ASSERT(nu_moves < MoveList::max_size);
     moves.get_unchecked(nu_moves) = mv;
     ++nu_moves;
@@ -254,6 +267,21 @@ void State::evaluate_multiplayer(array<Float, 6>& result)
     }
 }
 
+void State::evaluate_terminal(array<Float, 6>& result)
+{
+    LIBBOARDGAME_ASSERT(m_bd.get_nu_players() == 2);
+    auto s = m_bd.get_score_twoplayer(Color(0));
+    Float res;
+    if (s > 0)
+        res = 1;
+    else if (s < 0 || m_bd.get_break_ties())
+        res = 0;
+    else
+        res = 0.5;
+    for (Color c : Color::Range(m_nu_colors))
+        result[c.to_int()] = (c.to_int() % 2 == 0 ? res : 1 - res);
+}
+
 /** Evaluation function for game variants with 2 colors. */
 void State::evaluate_twocolor(array<Float, 6>& result)
 {
@@ -378,43 +406,43 @@ bool State::gen_children(Tree::NodeExpander& expander, Float root_val)
                 root_val);
 }
 
+template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
+inline bool State::gen_playout_move(const LastGoodReply& lgr, Move last,
+                                    Move second_last, PlayerMove& mv)
+{
+    if (m_nu_passes == m_nu_colors)
+        return false;
+    if (! m_is_symmetry_broken
+            && m_bd.get_nu_onboard_pieces() >= m_symmetry_min_nu_pieces)
+        // See also the comment in evaluate_playout()
+        return false;
+    PlayerInt player = get_player();
+    Move lgr2 = lgr.get_lgr2(player, last, second_last);
+    if (check_lgr(lgr2))
+    {
+        mv = {player, lgr2};
+        return true;
+    }
+    Move lgr1 = lgr.get_lgr1(player, last);
+    if (check_lgr(lgr1))
+    {
+        mv = {player, lgr1};
+        return true;
+    }
+    return gen_playout_move_full<MAX_SIZE, MAX_ADJ_ATTACH, IS_CALLISTO>(mv);
+}
+
+template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
 bool State::gen_playout_move_full(PlayerMove& mv)
 {
     Color to_play = m_bd.get_to_play();
     while (true)
     {
         if (! m_is_move_list_initialized[to_play])
-        {
-            if (m_max_piece_size == 5)
-            {
-                if (m_is_callisto)
-                    init_moves_with_gamma<5, 16, true>(to_play);
-                else
-                    init_moves_with_gamma<5, 16, false>(to_play);
-            }
-            else if (m_max_piece_size == 6)
-                init_moves_with_gamma<6, 22, false>(to_play);
-            else if (m_max_piece_size == 7)
-                init_moves_with_gamma<7, 12, false>(to_play);
-            else
-                init_moves_with_gamma<22, 44, false>(to_play);
-        }
+            init_moves_with_gamma<MAX_SIZE, MAX_ADJ_ATTACH, IS_CALLISTO>(
+                        to_play);
         else if (m_has_moves[to_play])
-        {
-            if (m_max_piece_size == 5)
-            {
-                if (m_is_callisto)
-                    update_moves<5, 16, true>(to_play);
-                else
-                    update_moves<5, 16, false>(to_play);
-            }
-            else if (m_max_piece_size == 6)
-                update_moves<6, 22, false>(to_play);
-            else if (m_max_piece_size == 7)
-                update_moves<7, 12, false>(to_play);
-            else
-                update_moves<22, 44, false>(to_play);
-        }
+            update_moves<MAX_SIZE, MAX_ADJ_ATTACH, IS_CALLISTO>(to_play);
         if ((m_has_moves[to_play] = ! m_moves[to_play].empty()))
             break;
         if (++m_nu_passes == m_nu_colors)
@@ -486,6 +514,14 @@ inline const Board::PiecesLeftList& State::get_pieces_considered(Color c)
     return m_pieces_considered;
 }
 
+bool State::has_complete_children() const
+{
+    auto to_play = m_bd.get_to_play();
+    return &get_is_piece_considered(to_play)
+            == &m_shared_const.is_piece_considered_all
+            && ! m_prior_knowledge.may_prune(m_bd, m_is_symmetry_broken);
+}
+
 /** Basic bonus added to the result for quality-based rewards.
     See also: Pepels et al.: Quality-based Rewards for Monte-Carlo Tree Search
     Simulations. ECAI 2014. */
@@ -720,6 +756,7 @@ void State::init_moves_without_gamma(Color c)
     marker.clear(moves);
     auto& pieces = get_pieces_considered<IS_CALLISTO>(c);
     auto& is_forbidden = m_bd.is_forbidden(c);
+    auto& forbidden_bits = m_bd.get_forbidden_bits(c);
     if (m_bd.is_first_piece(c) && ! IS_CALLISTO)
         add_starting_moves<MAX_SIZE>(c, pieces, false, moves);
     else
@@ -745,7 +782,8 @@ void State::init_moves_without_gamma(Color c)
                     for (Move mv : get_moves(c, piece, p, adj_status))
                         if (! marker[mv]
                                 && check_forbidden<MAX_SIZE>(
-                                    is_forbidden, mv, moves, nu_moves))
+                                    is_forbidden, forbidden_bits, mv, moves,
+                                    nu_moves))
                             marker.set(mv);
                 }
                 m_moves_added_at[c][p] = true;
@@ -767,7 +805,10 @@ void State::init_moves_without_gamma(Color c)
 void State::play_expanded_child(Move mv)
 {
     if (! mv.is_null())
+    {
+        m_hash ^= m_shared_const.hash_move[m_bd.get_to_play()][mv.to_int()];
         play_playout(mv);
+    }
     else
     {
         ++m_nu_passes;
@@ -780,6 +821,40 @@ void State::play_expanded_child(Move mv)
     }
 }
 
+void State::playout(const LastGoodReply& lgr, PlayoutMoves& moves)
+{
+    if (m_max_piece_size == 5)
+    {
+        if (m_is_callisto)
+            playout<5, 16, true>(lgr, moves);
+        else
+            playout<5, 16, false>(lgr, moves);
+    }
+    else if (m_max_piece_size == 6)
+        playout<6, 22, false>(lgr, moves);
+    else if (m_max_piece_size == 7)
+        playout<7, 12, false>(lgr, moves);
+    else
+        playout<22, 44, false>(lgr, moves);
+}
+
+template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
+void State::playout(const LastGoodReply& lgr, PlayoutMoves& moves)
+{
+    auto nu_moves = moves.size();
+    Move last = nu_moves > 0 ? moves[nu_moves - 1].move : Move::null();
+    Move second_last = nu_moves > 1 ? moves[nu_moves - 2].move : Move::null();
+    PlayerMove mv;
+    while (gen_playout_move<MAX_SIZE, MAX_ADJ_ATTACH, IS_CALLISTO>(
+               lgr, last, second_last, mv))
+    {
+        play_playout<MAX_SIZE, MAX_ADJ_ATTACH>(mv.move);
+        moves.push_back(mv);
+        second_last = last;
+        last = mv.move;
+    }
+}
+
 void State::start_search()
 {
     auto& bd = *m_shared_const.board;
@@ -790,10 +865,17 @@ void State::start_search()
     m_is_callisto = bd.is_callisto();
     for (Color c : Color::Range(m_nu_colors))
         m_playout_features[c].init_snapshot(m_bd, c);
+    m_root_hash = 0;
+    for (Color c : Color::Range(m_nu_colors))
+        for (Move mv : bd.get_setup().placements[c])
+            m_root_hash ^= m_shared_const.hash_move[c][mv.to_int()];
+    for (auto& mv : bd.get_moves())
+        m_root_hash ^= m_shared_const.hash_move[mv.color][mv.move.to_int()];
     m_bc = &m_bd.get_board_const();
     m_max_piece_size = m_bc->get_max_piece_size();
     m_move_info_array = m_bc->get_move_info_array();
     m_move_info_ext_array = m_bc->get_move_info_ext_array();
+    m_move_bits_array = m_bc->get_move_bits_array();
     m_check_terminate_early =
             (bd.get_nu_moves() < 10u * m_nu_colors
              && m_bd.get_nu_players() == 2);
@@ -830,6 +912,7 @@ void State::start_search()
 void State::start_simulation([[maybe_unused]] size_t n)
 {
     m_bd.restore_snapshot();
+    m_hash = m_root_hash;
     m_force_consider_all_pieces = false;
     auto& geo = m_bd.get_geometry();
     for (Color c : Color::Range(m_nu_colors))
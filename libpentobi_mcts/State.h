@@ -22,7 +22,9 @@ using libboardgame_base::RandomGenerator;
 using libboardgame_base::Statistics;
 using libboardgame_mcts::LastGoodReply;
 using libboardgame_mcts::PlayerInt;
+using libpentobi_base::Bitboard;
 using libpentobi_base::BoardConst;
+using libpentobi_base::MoveBits;
 using libpentobi_base::MoveInfo;
 using libpentobi_base::MoveInfoExt;
 using libpentobi_base::Piece;
@@ -44,7 +46,8 @@ class State
 {
 public:
     using Node =
-        libboardgame_mcts::Node<Move, Float, SearchParamConst::multithread>;
+        libboardgame_mcts::Node<Move, Float, SearchParamConst::multithread,
+                                SearchParamConst::compact_node>;
 
     using Tree = libboardgame_mcts::Tree<Node>;
 
@@ -56,6 +59,8 @@ public:
 
     using PlayerMove = libboardgame_mcts::PlayerMove<Move>;
 
+    using PlayoutMoves = ArrayList<PlayerMove, SearchParamConst::max_moves>;
+
 
     /** Constructor.
         @param initial_variant Game variant to initialize the internal
@@ -86,21 +91,48 @@ public:
 
     bool gen_children(Tree::NodeExpander& expander, Float root_val);
 
+    /** Check if gen_children() generates children for all legal moves in
+        the current position.
+        Used by the solver. Conservative check, may also return false if
+        all moves would be generated. */
+    bool has_complete_children() const;
+
     void start_playout() { }
 
-    /** Generate a playout move.
-        @return @c false if end of game was reached, and no move was
-        generated. */
-    bool gen_playout_move(const LastGoodReply& lgr, Move last,
-                          Move second_last, PlayerMove& mv);
+    /** Generate and play the moves of the playout phase.
+        The code for generating and playing the moves is instantiated for
+        each piece set. The instantiation is selected once per playout, so
+        that the loop over the moves contains no dispatching on the piece set
+        and the move generation can be fully inlined.
+        @param lgr The last good reply heuristic.
+        @param moves The moves of the simulation. Contains the moves of the
+        in-tree phase when called, the playout moves are appended. */
+    void playout(const LastGoodReply& lgr, PlayoutMoves& moves);
 
     void evaluate_playout(array<Float, 6>& result);
 
-    void play_playout(Move mv);
+    /** Evaluate a terminal position with the exact game result.
+        Used by the solver. Unlike evaluate_playout(), the result does not
+        contain heuristic bonuses and symmetric positions are not evaluated
+        as a draw.
+        @pre The game variant has two players. */
+    void evaluate_terminal(array<Float, 6>& result);
 
     /** Check if RAVE value for this move should not be updated. */
     bool skip_rave(Move mv) const;
 
+    /** Get the hash key of the current position for the transposition
+        table.
+        The hash key is only updated in the in-tree phase. It is computed
+        from the moves played by each color (which determines the board
+        position in Blokus independent of the move order) and the color to
+        play. */
+    HashKey get_hash() const;
+
+    /** Get the hash key of the position after playing a move.
+        @see get_hash() */
+    HashKey get_child_hash(Move mv) const;
+
 #ifdef LIBBOARDGAME_DEBUG
     string dump() const;
 #endif
@@ -108,13 +140,28 @@ public:
     string get_info() const;
 
 private:
-    /** The cumulative gamma value of the moves in m_moves. */
+    /** The cumulative gamma value of the moves in m_moves.
+        Rebuilt in the same pass over the move list that update_moves() needs
+        anyway for removing the moves that became illegal and for updating
+        the local features, which change the gamma values of all moves near
+        the last moves. An incremental structure (e.g. a Fenwick tree) does
+        not pay off: the move lists in the playouts are short (on average
+        about 55 moves in Classic, 120 in Trigon, 100 in Nexos) and 30-45% of
+        them are removed per update, while finding the changed moves without
+        scanning the list would require looking up the 100-350 precomputed
+        moves that cover each changed point. */
     array<float, MoveList::max_size> m_cumulative_gamma;
 
     Color::IntType m_nu_passes;
 
     const SharedConst& m_shared_const;
 
+    /** Hash key of the moves played, see get_hash(). */
+    HashKey m_hash;
+
+    /** Value of m_hash at the root position. */
+    HashKey m_root_hash;
+
     Board m_bd;
 
     const BoardConst* m_bc;
@@ -125,6 +172,9 @@ private:
 
     BoardConst::MoveInfoExtArray m_move_info_ext_array;
 
+    /** See BoardConst::get_move_bits_array() */
+    const MoveBits* m_move_bits_array;
+
     /** Incrementally updated lists of legal moves for both colors.
         Only the move list for the color to play van be used in any given
         position, the other color is not updated immediately after a move. */
@@ -255,6 +305,12 @@ private:
 
     void init_gamma();
 
+    /** Initialize the move list of a color at the start of the playout.
+        The same leaf position of the in-tree phase is usually reached in
+        several simulations before it is expanded, but caching the move list
+        per leaf does not pay off: a cache with 1024 entries had a hit rate
+        of 40-50% but saved only 1-3% of the playout time and used up to
+        4 MB per thread (Trigon). */
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
     void init_moves_with_gamma(Color c);
 
@@ -262,7 +318,8 @@ private:
     void init_moves_without_gamma(Color c);
 
     template<unsigned MAX_SIZE>
-    bool check_forbidden(const GridExt<bool>& is_forbidden, Move mv,
+    bool check_forbidden(const GridExt<bool>& is_forbidden,
+                         const Bitboard& forbidden_bits, Move mv,
                          MoveList& moves, unsigned& nu_moves);
 
     bool check_lgr(Move mv) const;
@@ -279,8 +336,24 @@ private:
                     const PlayoutFeatures& playout_features,
                     float& total_gamma);
 
+    /** Generate a playout move.
+        @return @c false if end of game was reached, and no move was
+        generated. */
+    template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
+    bool gen_playout_move(const LastGoodReply& lgr, Move last,
+                          Move second_last, PlayerMove& mv);
+
+    template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
     bool gen_playout_move_full(PlayerMove& mv);
 
+    void play_playout(Move mv);
+
+    template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
+    void play_playout(Move mv);
+
+    template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
+    void playout(const LastGoodReply& lgr, PlayoutMoves& moves);
+
     template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH, bool IS_CALLISTO>
     void update_moves(Color c);
 
@@ -345,29 +418,18 @@ inline void State::finish_in_tree()
         m_is_symmetry_broken = check_symmetry_broken(m_bd);
 }
 
-inline bool State::gen_playout_move(const LastGoodReply& lgr, Move last,
-                                    Move second_last, PlayerMove& mv)
+inline HashKey State::get_child_hash(Move mv) const
 {
-    if (m_nu_passes == m_nu_colors)
-        return false;
-    if (! m_is_symmetry_broken
-            && m_bd.get_nu_onboard_pieces() >= m_symmetry_min_nu_pieces)
-        // See also the comment in evaluate_playout()
-        return false;
-    PlayerInt player = get_player();
-    Move lgr2 = lgr.get_lgr2(player, last, second_last);
-    if (check_lgr(lgr2))
-    {
-        mv = {player, lgr2};
-        return true;
-    }
-    Move lgr1 = lgr.get_lgr1(player, last);
-    if (check_lgr(lgr1))
-    {
-        mv = {player, lgr1};
-        return true;
-    }
-    return gen_playout_move_full(mv);
+    Color to_play = m_bd.get_to_play();
+    auto hash = m_hash;
+    if (! mv.is_null())
+        hash ^= m_shared_const.hash_move[to_play][mv.to_int()];
+    return hash ^ m_shared_const.hash_to_play[to_play.get_next(m_nu_colors)];
+}
+
+inline HashKey State::get_hash() const
+{
+    return m_hash ^ m_shared_const.hash_to_play[m_bd.get_to_play()];
 }
 
 template<unsigned MAX_SIZE>
@@ -413,6 +475,7 @@ inline void State::play_in_tree(Move mv)
     {
         LIBBOARDGAME_ASSERT(m_bd.is_legal(to_play, mv));
         m_nu_passes = 0;
+        m_hash ^= m_shared_const.hash_move[to_play][mv.to_int()];
         if (m_max_piece_size == 5)
         {
             m_bd.play<5, 16>(to_play, mv);
@@ -443,36 +506,30 @@ inline void State::play_in_tree(Move mv)
 
 inline void State::play_playout(Move mv)
 {
-    auto to_play = m_bd.get_to_play();
-    LIBBOARDGAME_ASSERT(m_bd.is_legal(to_play, mv));
     if (m_max_piece_size == 5)
-    {
-        m_bd.play<5, 16>(to_play, mv);
-        update_playout_features<5, 16>(to_play, mv);
-        if (! m_is_symmetry_broken)
-            update_symmetry_broken<5>(mv);
-    }
+        play_playout<5, 16>(mv);
     else if (m_max_piece_size == 6)
-    {
-        m_bd.play<6, 22>(to_play, mv);
-        update_playout_features<6, 22>(to_play, mv);
-        if (! m_is_symmetry_broken)
-            update_symmetry_broken<6>(mv);
-    }
+        play_playout<6, 22>(mv);
     else if (m_max_piece_size == 7)
+        play_playout<7, 12>(mv);
+    else
+        play_playout<22, 44>(mv);
+}
+
+template<unsigned MAX_SIZE, unsigned MAX_ADJ_ATTACH>
+inline void State::play_playout(Move mv)
+{
+    auto to_play = m_bd.get_to_play();
+    LIBBOARDGAME_ASSERT(m_bd.is_legal(to_play, mv));
+    m_bd.play<MAX_SIZE, MAX_ADJ_ATTACH>(to_play, mv);
+    update_playout_features<MAX_SIZE, MAX_ADJ_ATTACH>(to_play, mv);
+    if constexpr (MAX_SIZE == 7)
     {
-        m_bd.play<7, 12>(to_play, mv);
-        update_playout_features<7, 12>(to_play, mv);
         // No game variant with piece size 7 uses m_is_symmetry_broken
         LIBBOARDGAME_ASSERT(m_is_symmetry_broken);
     }
-    else
-    {
-        m_bd.play<22, 44>(to_play, mv);
-        update_playout_features<22, 44>(to_play, mv);
-        if (! m_is_symmetry_broken)
-            update_symmetry_broken<22>(mv);
-    }
+    else if (! m_is_symmetry_broken)
+        update_symmetry_broken<MAX_SIZE>(mv);
     ++m_nu_new_moves[to_play];
     m_last_move[to_play] = mv;
     m_nu_passes = 0;
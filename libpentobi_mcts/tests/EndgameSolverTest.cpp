@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/tests/EndgameSolverTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libpentobi_mcts/EndgameSolver.h"
+
+#include "libboardgame_base/CpuTimeSource.h"
+#include "libboardgame_base/SgfUtil.h"
+#include "libboardgame_base/TreeReader.h"
+#include "libboardgame_test/Test.h"
+#include "libpentobi_base/BoardUpdater.h"
+#include "libpentobi_base/PentobiTree.h"
+
+using namespace std;
+using namespace libpentobi_mcts;
+using libboardgame_base::CpuTimeSource;
+using libboardgame_base::SgfNode;
+using libboardgame_base::TreeReader;
+using libboardgame_base::get_last_node;
+using libpentobi_base::BoardUpdater;
+using libpentobi_base::PentobiTree;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Minimax search without pruning for checking the result of the solver.
+    @return The final score from the view point of the first player. */
+ScoreType minimax(const Board& bd, MoveMarker& marker)
+{
+    auto nu_colors = bd.get_nu_colors();
+    auto c = bd.get_to_play();
+    MoveList moves;
+    for (Color::IntType i = 0; ; ++i)
+    {
+        if (i == nu_colors)
+            return bd.get_score_twoplayer(Color(0));
+        bd.gen_moves(c, marker, moves);
+        marker.clear(moves);
+        if (! moves.empty())
+            break;
+        c = c.get_next(nu_colors);
+    }
+    bool is_max = (c.to_int() % 2 == 0);
+    auto result = is_max ? numeric_limits<ScoreType>::lowest()
+                         : numeric_limits<ScoreType>::max();
+    auto child = make_unique<Board>(bd.get_variant());
+    for (Move mv : moves)
+    {
+        child->copy_from(bd);
+        child->play(c, mv);
+        auto value = minimax(*child, marker);
+        result = is_max ? max(result, value) : min(result, value);
+    }
+    return result;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+/** Test the solver with a Duo endgame position.
+    The score must be the same as the score of a full minimax search, the move
+    must achieve this score and the solver must fail if the node limit is
+    exceeded. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_endgame_solver_duo)
+{
+    istringstream
+        in(R"delim(
+           (;GM[Blokus Duo];B[e9,d10,e10,f10,e11];W[j5,i6,j6,k6,j7]
+           ;B[h7,i7,g8,h8,g9];W[g5,h5,f6,g6,g7];B[l7,j8,k8,l8,k9]
+           ;W[d7,e7,c8,d8,c9];B[k4,k5,l5,m5,m6];W[i8,i9,i10,j10,j11]
+           ;B[g2,g3,h3,i3,j3];W[f11,g11,h11,f12,g12];B[e4,f4,d5,e5,f5]
+           ;W[c3,b4,c4,c5,c6];B[l10,l11,k12,l12,k13]
+           ;W[b10,b11,c11,d11,d12];B[d1,b2,c2,d2,d3]
+           ;W[i12,i13,i14,j14,k14];B[a3,a4,a5,a6,a7]
+           ;W[a12,a13,b13,c13,a14];B[n11,n12,m13,n13,n14]
+           ;W[d14,e14,f14,g14];B[n7,n8,m9,n9];W[l13];B[b8,a9,b9,a10]
+           ;W[m11,m12])
+           )delim");
+    TreeReader reader;
+    reader.read(in);
+    unique_ptr<SgfNode> root = reader.get_tree_transfer_ownership();
+    PentobiTree tree(root);
+    auto bd = make_unique<Board>(tree.get_variant());
+    BoardUpdater updater;
+    updater.update(*bd, tree, get_last_node(tree.get_root()));
+    auto solver = make_unique<EndgameSolver>(bd->get_variant());
+    CpuTimeSource time_source;
+    Move mv;
+    ScoreType score;
+    bool res = solver->solve(*bd, Color(0), 0, 0, time_source, mv, score);
+    LIBBOARDGAME_CHECK(res);
+    LIBBOARDGAME_CHECK(bd->is_legal(Color(0), mv));
+    auto marker = make_unique<MoveMarker>();
+    LIBBOARDGAME_CHECK_EQUAL(score, minimax(*bd, *marker));
+    // The search tree has more nodes than this limit
+    Move mv_limited;
+    ScoreType score_limited;
+    LIBBOARDGAME_CHECK(! solver->solve(*bd, Color(0), 10, 0, time_source,
+                                       mv_limited, score_limited));
+    bd->play(Color(0), mv);
+    LIBBOARDGAME_CHECK_EQUAL(score, minimax(*bd, *marker));
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+/** @file libpentobi_mcts/tests/SearchPoolTest.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "libpentobi_mcts/SearchPool.h"
+
+#include "libboardgame_test/Test.h"
+
+using namespace std;
+using namespace libpentobi_mcts;
+
+//-----------------------------------------------------------------------------
+
+/** Test that the callbacks of all requests are called with a legal move,
+    including requests in different game variants and more requests than
+    worker threads. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_pool_basic)
+{
+    unsigned nu_threads = 2;
+    size_t memory = 1000000;
+    SearchPool pool(Variant::duo, nu_threads, memory);
+    vector<unique_ptr<Board>> boards;
+    for (auto variant : { Variant::duo, Variant::classic_2, Variant::trigon_2,
+                          Variant::duo, Variant::junior })
+    {
+        boards.push_back(make_unique<Board>(variant));
+        boards.back()->init();
+    }
+    auto& bd = *boards[3];
+    Move mv;
+    LIBBOARDGAME_CHECK(bd.from_string(mv, "e8,d9,e9,f9,e10"));
+    bd.play(Color(0), mv);
+    mutex results_mutex;
+    vector<SearchPool::Result> results(boards.size());
+    vector<bool> is_finished(boards.size(), false);
+    for (size_t i = 0; i < boards.size(); ++i)
+    {
+        auto c = boards[i]->get_effective_to_play();
+        pool.submit(*boards[i], c, 50, 0, [&, i](const auto& result) {
+            lock_guard lock(results_mutex);
+            results[i] = result;
+            is_finished[i] = true;
+        });
+    }
+    pool.wait();
+    for (size_t i = 0; i < boards.size(); ++i)
+    {
+        LIBBOARDGAME_CHECK(is_finished[i]);
+        LIBBOARDGAME_CHECK(! results[i].mv.is_null());
+        auto c = boards[i]->get_effective_to_play();
+        LIBBOARDGAME_CHECK(boards[i]->is_legal(c, results[i].mv));
+    }
+}
+
+/** Test that the destructor aborts a running search without a limit and
+    discards the queued requests. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_pool_destroy)
+{
+    auto pool = make_unique<SearchPool>(Variant::duo, 1, 1000000);
+    auto bd = make_unique<Board>(Variant::duo);
+    bd->init();
+    atomic<unsigned> nu_callbacks{0};
+    atomic<bool> was_aborted{true};
+    for (unsigned i = 0; i < 3; ++i)
+        pool->submit(*bd, Color(0), 0, numeric_limits<double>::max(),
+                     [&](const auto& result) {
+            ++nu_callbacks;
+            if (! result.was_aborted)
+                was_aborted = false;
+        });
+    pool.reset();
+    LIBBOARDGAME_CHECK(nu_callbacks <= 1);
+    LIBBOARDGAME_CHECK(was_aborted);
+}
+
+//-----------------------------------------------------------------------------
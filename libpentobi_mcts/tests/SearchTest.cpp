@@ -106,4 +106,99 @@ LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_callisto_useless_one_piece)
     LIBBOARDGAME_CHECK(bd->get_move_piece(mv) == bd->get_one_piece());
 }
 
+/** Test that the solver proves a won endgame position.
+    Black can win in this Duo position. The search should find a winning
+    move with a proven value and stop early. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_solver)
+{
+    istringstream
+        in(R"delim(
+           (;GM[Blokus Duo];B[e9,d10,e10,f10,e11];W[j5,i6,j6,k6,j7]
+           ;B[h7,i7,g8,h8,g9];W[g5,h5,f6,g6,g7];B[l7,j8,k8,l8,k9]
+           ;W[d7,e7,c8,d8,c9];B[k4,k5,l5,m5,m6];W[i8,i9,i10,j10,j11]
+           ;B[g2,g3,h3,i3,j3];W[f11,g11,h11,f12,g12];B[e4,f4,d5,e5,f5]
+           ;W[c3,b4,c4,c5,c6];B[l10,l11,k12,l12,k13]
+           ;W[b10,b11,c11,d11,d12];B[d1,b2,c2,d2,d3]
+           ;W[i12,i13,i14,j14,k14];B[a3,a4,a5,a6,a7]
+           ;W[a12,a13,b13,c13,a14];B[n11,n12,m13,n13,n14]
+           ;W[d14,e14,f14,g14];B[n7,n8,m9,n9];W[l13];B[b8,a9,b9,a10]
+           ;W[m11,m12])
+           )delim");
+    TreeReader reader;
+    reader.read(in);
+    unique_ptr<SgfNode> root = reader.get_tree_transfer_ownership();
+    PentobiTree tree(root);
+    auto bd = make_unique<Board>(tree.get_variant());
+    BoardUpdater updater;
+    updater.update(*bd, tree, get_last_node(tree.get_root()));
+    unsigned nu_threads = 1;
+    size_t memory = 10000000;
+    auto search = make_unique<Search>(bd->get_variant(), nu_threads, memory);
+    Float max_count = 100000;
+    size_t min_simulations = 0;
+    double max_time = 0;
+    CpuTimeSource time_source;
+    Move mv;
+    bool res = search->search(mv, *bd, Color(0), max_count, min_simulations,
+                              max_time, time_source);
+    LIBBOARDGAME_CHECK(res);
+    LIBBOARDGAME_CHECK(search->get_nu_simulations() < 100000);
+    auto child = search->select_final();
+    LIBBOARDGAME_CHECK(child->get_move() == mv);
+    LIBBOARDGAME_CHECK(child->is_proven());
+    LIBBOARDGAME_CHECK_EQUAL(child->get_value(), 1.f);
+}
+
+/** Test that the move with the most visits is selected if the root position
+    is a proven loss.
+    All children of the root are proven losses with the same number of wins in
+    this case. Uses the position of pentobi_mcts_search_solver before the last
+    move, in which all moves of White lose. */
+LIBBOARDGAME_TEST_CASE(pentobi_mcts_search_solver_proven_loss)
+{
+    istringstream
+        in(R"delim(
+           (;GM[Blokus Duo];B[e9,d10,e10,f10,e11];W[j5,i6,j6,k6,j7]
+           ;B[h7,i7,g8,h8,g9];W[g5,h5,f6,g6,g7];B[l7,j8,k8,l8,k9]
+           ;W[d7,e7,c8,d8,c9];B[k4,k5,l5,m5,m6];W[i8,i9,i10,j10,j11]
+           ;B[g2,g3,h3,i3,j3];W[f11,g11,h11,f12,g12];B[e4,f4,d5,e5,f5]
+           ;W[c3,b4,c4,c5,c6];B[l10,l11,k12,l12,k13]
+           ;W[b10,b11,c11,d11,d12];B[d1,b2,c2,d2,d3]
+           ;W[i12,i13,i14,j14,k14];B[a3,a4,a5,a6,a7]
+           ;W[a12,a13,b13,c13,a14];B[n11,n12,m13,n13,n14]
+           ;W[d14,e14,f14,g14];B[n7,n8,m9,n9];W[l13];B[b8,a9,b9,a10])
+           )delim");
+    TreeReader reader;
+    reader.read(in);
+    unique_ptr<SgfNode> root = reader.get_tree_transfer_ownership();
+    PentobiTree tree(root);
+    auto bd = make_unique<Board>(tree.get_variant());
+    BoardUpdater updater;
+    updater.update(*bd, tree, get_last_node(tree.get_root()));
+    unsigned nu_threads = 1;
+    size_t memory = 10000000;
+    auto search = make_unique<Search>(bd->get_variant(), nu_threads, memory);
+    Float max_count = 100000;
+    size_t min_simulations = 0;
+    double max_time = 0;
+    CpuTimeSource time_source;
+    Move mv;
+    bool res = search->search(mv, *bd, Color(1), max_count, min_simulations,
+                              max_time, time_source);
+    LIBBOARDGAME_CHECK(res);
+    LIBBOARDGAME_CHECK(search->get_nu_simulations() < 100000);
+    auto children = search->get_tree().get_root_children();
+    LIBBOARDGAME_CHECK(children.size() > 1);
+    Float max_visit_count = 0;
+    for (auto& i : children)
+    {
+        LIBBOARDGAME_CHECK(i.is_proven());
+        LIBBOARDGAME_CHECK_EQUAL(i.get_value(), 0.f);
+        max_visit_count = max(max_visit_count, i.get_visit_count());
+    }
+    auto child = search->select_final();
+    LIBBOARDGAME_CHECK(child->get_move() == mv);
+    LIBBOARDGAME_CHECK_EQUAL(child->get_visit_count(), max_visit_count);
+}
+
 //-----------------------------------------------------------------------------
@@ -32,7 +32,7 @@ PlayerModel::PlayerModel(QObject* parent)
     }
     if (noBook)
         m_player->set_use_book(false);
-    m_player->get_search().set_callback(
+    m_player->set_callback(
                 [this](double elapsedSeconds, double remainingSeconds) {
         emit searchCallback(elapsedSeconds, remainingSeconds);
     });
@@ -7,12 +7,18 @@
 #include "GtpEngine.h"
 
 #include <fstream>
+#include <thread>
+#include "SelfPlay.h"
+#include "libboardgame_base/WallTimeSource.h"
 #include "libboardgame_base/Writer.h"
 #include "libpentobi_mcts/Util.h"
 
+using libboardgame_base::WallTimeSource;
 using libboardgame_base::Writer;
 using libboardgame_gtp::Failure;
 using libpentobi_base::Board;
+using libpentobi_base::Move;
+using libpentobi_base::ScoreType;
 using libpentobi_base::get_color_id;
 using libpentobi_mcts::Float;
 
@@ -26,11 +32,17 @@ GtpEngine::GtpEngine(
     create_player(variant, level, books_dir, nu_threads);
     get_mcts_player().set_use_book(use_book);
     add("get_value", &GtpEngine::cmd_get_value);
+    add("load_snapshot", &GtpEngine::cmd_load_snapshot);
+    add("move_values", &GtpEngine::cmd_move_values);
     add("name", &GtpEngine::cmd_name);
     add("param", &GtpEngine::cmd_param);
-    add("move_values", &GtpEngine::cmd_move_values);
+    add("ponder", &GtpEngine::cmd_ponder);
+    add("save_snapshot", &GtpEngine::cmd_save_snapshot);
     add("save_tree", &GtpEngine::cmd_save_tree);
     add("selfplay", &GtpEngine::cmd_selfplay);
+    add("selfplay_data", &GtpEngine::cmd_selfplay_data);
+    add("solve", &GtpEngine::cmd_solve);
+    add("stop_ponder", &GtpEngine::cmd_stop_ponder);
     add("version", &GtpEngine::cmd_version);
 }
 
@@ -41,6 +53,21 @@ void GtpEngine::cmd_get_value(Response& response)
     response << get_search().get_tree().get_root().get_value();
 }
 
+/** Restore the search tree from a file written by save_snapshot.
+    The tree is reused by the next search if it is in the same position or
+    a follow-up position of the saved tree. */
+void GtpEngine::cmd_load_snapshot(Arguments args)
+{
+    try
+    {
+        get_search().load_snapshot(args.get<string>());
+    }
+    catch (const runtime_error& e)
+    {
+        throw Failure(e.what());
+    }
+}
+
 void GtpEngine::cmd_move_values(Response& response)
 {
     auto children = get_search().get_tree().get_root_children();
@@ -65,6 +92,27 @@ void GtpEngine::cmd_name(Response& response)
     response.set("Pentobi");
 }
 
+void GtpEngine::cmd_ponder()
+{
+    auto& bd = get_board();
+    get_mcts_player().start_ponder(bd, bd.get_effective_to_play());
+}
+
+/** Save the search tree of the last search in a binary format.
+    Unlike save_tree, the file is small and fast to load and can be used for
+    continuing a search after restarting the engine with load_snapshot. */
+void GtpEngine::cmd_save_snapshot(Arguments args)
+{
+    try
+    {
+        get_search().save_snapshot(args.get<string>());
+    }
+    catch (const runtime_error& e)
+    {
+        throw Failure(e.what());
+    }
+}
+
 void GtpEngine::cmd_save_tree(Arguments args)
 {
     auto& search = get_search();
@@ -114,6 +162,34 @@ void GtpEngine::cmd_selfplay(Arguments args)
     }
 }
 
+/** Generate training data with self-play games played in parallel.
+    Arguments: number of games, data file, number of threads (optional,
+    default is the number of hardware threads). The number of simulations
+    per move is the value of the parameter fixed_simulations or 10000 if
+    it is not set. See SelfPlay for the file format. */
+void GtpEngine::cmd_selfplay_data(Arguments args)
+{
+    args.check_size_less_equal(3);
+    auto nu_games = args.get<unsigned>(0);
+    auto file = args.get<string>(1);
+    unsigned nu_threads = max(thread::hardware_concurrency(), 1u);
+    if (args.get_size() > 2)
+        nu_threads = args.get_min<unsigned>(2, 1);
+    auto simulations = get_mcts_player().get_fixed_simulations();
+    if (simulations == 0)
+        simulations = 10000;
+    try
+    {
+        SelfPlay selfplay(get_board().get_variant(), nu_threads, simulations,
+                          8);
+        selfplay.run(nu_games, file);
+    }
+    catch (const runtime_error& e)
+    {
+        throw Failure(e.what());
+    }
+}
+
 void GtpEngine::cmd_param(Arguments args, Response& response)
 {
     auto& p = get_mcts_player();
@@ -121,12 +197,17 @@ void GtpEngine::cmd_param(Arguments args, Response& response)
     if (args.get_size() == 0)
         response
             << "avoid_symmetric_draw " << s.get_avoid_symmetric_draw() << '\n'
+            << "endgame_solver " << p.get_use_endgame_solver() << '\n'
             << "exploration_constant " << s.get_exploration_constant() << '\n'
             << "fixed_simulations " << p.get_fixed_simulations() << '\n'
+            << "nu_thread_groups " << s.get_nu_thread_groups() << '\n'
             << "rave_child_max " << s.get_rave_child_max() << '\n'
             << "rave_parent_max " << s.get_rave_parent_max() << '\n'
             << "rave_weight " << s.get_rave_weight() << '\n'
             << "reuse_subtree " << s.get_reuse_subtree() << '\n'
+            << "solver " << s.get_use_solver() << '\n'
+            << "transposition_table " << s.get_use_transposition_table()
+            << '\n'
             << "use_book " << p.get_use_book() << '\n';
     else
     {
@@ -134,10 +215,14 @@ void GtpEngine::cmd_param(Arguments args, Response& response)
         auto name = args.get(0);
         if (name == "avoid_symmetric_draw")
             s.set_avoid_symmetric_draw(args.get<bool>(1));
+        else if (name == "endgame_solver")
+            p.set_use_endgame_solver(args.get<bool>(1));
         else if (name == "exploration_constant")
             s.set_exploration_constant(args.get<Float>(1));
         else if (name == "fixed_simulations")
             p.set_fixed_simulations(args.get<Float>(1));
+        else if (name == "nu_thread_groups")
+            s.set_nu_thread_groups(args.get_min<unsigned>(1, 1));
         else if (name == "rave_child_max")
             s.set_rave_child_max(args.get<Float>(1));
         else if (name == "rave_parent_max")
@@ -146,6 +231,10 @@ void GtpEngine::cmd_param(Arguments args, Response& response)
             s.set_rave_weight(args.get<Float>(1));
         else if (name == "reuse_subtree")
             s.set_reuse_subtree(args.get<bool>(1));
+        else if (name == "solver")
+            s.set_use_solver(args.get<bool>(1));
+        else if (name == "transposition_table")
+            s.set_use_transposition_table(args.get<bool>(1));
         else if (name == "use_book")
             p.set_use_book(args.get<bool>(1));
         else
@@ -157,6 +246,36 @@ void GtpEngine::cmd_param(Arguments args, Response& response)
     }
 }
 
+/** Solve the current position with the exact endgame solver.
+    Responds with the best move and the final score of the color to play if
+    both players play perfectly. An optional argument limits the number of
+    nodes searched (default is no limit). */
+void GtpEngine::cmd_solve(Arguments args, Response& response)
+{
+    args.check_size_less_equal(1);
+    size_t max_nodes = 0;
+    if (args.get_size() > 0)
+        max_nodes = args.get<size_t>(0);
+    auto& bd = get_board();
+    if (bd.get_nu_players() != 2)
+        throw Failure("only two-player game variants are supported");
+    if (bd.is_game_over())
+        throw Failure("game is over");
+    auto c = bd.get_effective_to_play();
+    WallTimeSource time_source;
+    Move mv;
+    ScoreType score;
+    if (! get_mcts_player().get_endgame_solver().solve(
+            bd, c, max_nodes, 0, time_source, mv, score))
+        throw Failure("node limit exceeded");
+    response << bd.to_string(mv, false) << ' ' << score;
+}
+
+void GtpEngine::cmd_stop_ponder()
+{
+    // Pondering was already stopped in on_handle_cmd_begin()
+}
+
 void GtpEngine::cmd_version(Response& response)
 {
     string version;
@@ -192,6 +311,12 @@ Player& GtpEngine::get_mcts_player()
     }
 }
 
+void GtpEngine::on_handle_cmd_begin()
+{
+    get_mcts_player().stop_ponder();
+    libpentobi_gtp::GtpEngine::on_handle_cmd_begin();
+}
+
 Search& GtpEngine::get_search()
 {
     return get_mcts_player().get_search();
@@ -32,10 +32,16 @@ public:
 
     void cmd_param(Arguments args, Response& response);
     void cmd_get_value(Response& response);
+    void cmd_load_snapshot(Arguments args);
     void cmd_move_values(Response& response);
     void cmd_name(Response& response);
+    void cmd_ponder();
     void cmd_selfplay(Arguments args);
+    void cmd_selfplay_data(Arguments args);
+    void cmd_save_snapshot(Arguments args);
     void cmd_save_tree(Arguments args);
+    void cmd_solve(Arguments args, Response& response);
+    void cmd_stop_ponder();
     void cmd_version(Response& response);
 
     Player& get_mcts_player();
@@ -43,6 +49,10 @@ public:
     /** @see Player::use_cpu_time() */
     void use_cpu_time(bool enable);
 
+protected:
+    /** Stops pondering before any command is handled. */
+    void on_handle_cmd_begin() override;
+
 private:
     unique_ptr<PlayerBase> m_player;
 
@@ -16,6 +16,7 @@ using libboardgame_base::RandomGenerator;
 using libboardgame_gtp::Failure;
 using libpentobi_base::parse_variant_id;
 using libpentobi_base::Board;
+using libpentobi_base::BoardConst;
 using libpentobi_base::Variant;
 using libpentobi_mcts::Player;
 
@@ -50,6 +51,7 @@ int main(int argc, char** argv)
     {
         vector<string> specs = {
             "book:",
+            "cache-dir:",
             "config|c:",
             "color",
             "cputime",
@@ -70,6 +72,7 @@ int main(int argc, char** argv)
             cout <<
                 "Usage: pentobi_gtp [options] [input files]\n"
                 "--book       load an external book file\n"
+                "--cache-dir  directory for caching precomputed moves\n"
                 "--config,-c  set GTP config file\n"
                 "--color      colorize text output of boards\n"
                 "--cputime    use CPU time\n"
@@ -109,6 +112,7 @@ int main(int argc, char** argv)
         if (opt.contains("seed"))
             RandomGenerator::set_global_seed(
                         opt.get<RandomGenerator::ResultType>("seed"));
+        BoardConst::set_cache_dir(opt.get("cache-dir", ""));
         string variant_string = opt.get("game", "classic");
         Variant variant;
         if (! parse_variant_id(variant_string, variant))
@@ -125,7 +129,10 @@ int main(int argc, char** argv)
         if (opt.contains("cputime"))
             engine.use_cpu_time(true);
         string book_file = opt.get("book", "");
-        if (! book_file.empty())
+        if (book_file.size() > 8
+                && book_file.compare(book_file.size() - 8, 8, ".blkbook") == 0)
+            engine.get_mcts_player().load_compiled_book(book_file);
+        else if (! book_file.empty())
         {
             ifstream in(book_file);
             engine.get_mcts_player().load_book(in);
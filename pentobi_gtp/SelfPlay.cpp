@@ -0,0 +1,274 @@
+//-----------------------------------------------------------------------------
+/** @file pentobi_gtp/SelfPlay.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "SelfPlay.h"
+
+#include <cstring>
+#include <thread>
+#include "libboardgame_base/BinaryIO.h"
+#include "libboardgame_base/Memory.h"
+#include "libboardgame_base/WallTimeSource.h"
+#include "libpentobi_base/ScoreUtil.h"
+
+using libboardgame_base::write_binary;
+using libboardgame_base::WallTimeSource;
+using libpentobi_base::BoardConst;
+using libpentobi_base::Color;
+using libpentobi_base::Move;
+using libpentobi_base::ScoreType;
+using libpentobi_base::get_multiplayer_result;
+
+//-----------------------------------------------------------------------------
+
+/** A position of a game with the search result. */
+struct SelfPlay::Position
+{
+    Color to_play;
+
+    Move mv;
+
+    Float value;
+
+    /** Moves and visit counts of the root children. */
+    vector<pair<Move, Float>> children;
+};
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Identifier at the beginning of self-play data files.
+    Needs to be changed if the format changes. */
+const array<char, 16> selfplay_magic = {
+    'P', 'E', 'N', 'T', 'O', 'B', 'I', '-', 'S', 'E', 'L', 'F', '-', '0', '1',
+    '\n' };
+
+/** Parameters of a self-play data file stored after selfplay_magic. */
+struct SelfPlayHeader
+{
+    array<char, 32> variant;
+
+    uint_least32_t move_range;
+};
+
+/** Get the game result for each player. */
+void get_result(const Board& bd, array<float, Color::range>& result)
+{
+    auto nu_players = bd.get_nu_players();
+    if (nu_players == 2)
+    {
+        auto score = bd.get_score_twoplayer(Color(0));
+        if (score > 0)
+            result[0] = 1;
+        else if (score < 0 || (bd.get_break_ties() && score == 0))
+            result[0] = 0;
+        else
+            result[0] = 0.5;
+        result[1] = 1 - result[0];
+    }
+    else
+    {
+        array<ScoreType, Color::range> points;
+        for (Color::IntType i = 0; i < bd.get_nu_colors(); ++i)
+            points[i] = bd.get_points(Color(i));
+        get_multiplayer_result(nu_players, points, result,
+                               bd.get_break_ties());
+    }
+}
+
+/** Memory used for the search tree of each thread. */
+size_t get_memory(unsigned nu_threads)
+{
+    auto available = libboardgame_base::get_memory();
+    if (available == 0)
+        available = 512000000;
+    return min(available / 4 / nu_threads, size_t(2000000000));
+}
+
+SelfPlayHeader get_header(Variant variant)
+{
+    SelfPlayHeader header;
+    header.variant.fill('\0');
+    auto id = to_string_id(variant);
+    memcpy(header.variant.data(), id,
+           min(strlen(id), header.variant.size() - 1));
+    header.move_range = BoardConst::get(variant).get_range();
+    return header;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+SelfPlay::SelfPlay(Variant variant, unsigned nu_threads, Float simulations,
+                   unsigned nu_sampled_moves)
+    : m_variant(variant),
+      m_simulations(simulations),
+      m_nu_sampled_moves(nu_sampled_moves)
+{
+    nu_threads = max(nu_threads, 1u);
+    auto memory = get_memory(nu_threads);
+    for (unsigned i = 0; i < nu_threads; ++i)
+    {
+        m_searches.push_back(make_unique<Search>(variant, 1, memory));
+        m_boards.push_back(make_unique<Board>(variant));
+        m_random.push_back(make_unique<RandomGenerator>());
+        // Avoid identical games if a global random seed was set
+        m_random.back()->set_seed(m_random.back()->generate() + i);
+    }
+}
+
+SelfPlay::~SelfPlay() = default;
+
+void SelfPlay::open(const string& file)
+{
+    auto header = get_header(m_variant);
+    ifstream in(file, ios::binary);
+    if (in && in.peek() != ifstream::traits_type::eof())
+    {
+        // Append to data of the same game variant
+        array<char, 16> magic;
+        SelfPlayHeader file_header;
+        in.read(magic.data(), magic.size());
+        in.read(reinterpret_cast<char*>(&file_header), sizeof(file_header));
+        if (! in || magic != selfplay_magic
+                || file_header.variant != header.variant
+                || file_header.move_range != header.move_range)
+            throw runtime_error(file + ": wrong format or game variant");
+        m_out.open(file, ios::binary | ios::app);
+    }
+    else
+    {
+        m_out.open(file, ios::binary | ios::trunc);
+        write_binary(m_out, selfplay_magic);
+        write_binary(m_out, header);
+    }
+    if (! m_out)
+        throw runtime_error("could not write " + file);
+}
+
+void SelfPlay::play_game(unsigned i, vector<Position>& positions)
+{
+    auto& bd = *m_boards[i];
+    auto& search = *m_searches[i];
+    auto& random = *m_random[i];
+    WallTimeSource time_source;
+    positions.clear();
+    bd.init();
+    while (! bd.is_game_over())
+    {
+        auto c = bd.get_effective_to_play();
+        Move mv;
+        if (! search.search(mv, bd, c, m_simulations, 0, 0, time_source))
+            throw runtime_error("selfplay: no move generated");
+        Position pos;
+        pos.to_play = c;
+        // The root node does not store a value if its subtree was reused, use
+        // the value of the best child like the search does
+        auto best = search.select_final();
+        pos.value = (best != nullptr ? best->get_value() : 0.5f);
+        Float sum = 0;
+        for (auto& child : search.get_tree().get_root_children())
+        {
+            pos.children.emplace_back(child.get_move(),
+                                      child.get_visit_count());
+            sum += child.get_visit_count();
+        }
+        if (bd.get_nu_moves() < m_nu_sampled_moves && sum > 0)
+        {
+            auto r = static_cast<Float>(random.generate_double(0, sum));
+            for (auto& child : pos.children)
+            {
+                mv = child.first;
+                if (r < child.second)
+                    break;
+                r -= child.second;
+            }
+        }
+        pos.mv = mv;
+        positions.push_back(move(pos));
+        bd.play(c, mv);
+    }
+}
+
+void SelfPlay::play_games(unsigned i)
+{
+    vector<Position> positions;
+    while (m_nu_games_started.fetch_add(1) < m_nu_games)
+    {
+        play_game(i, positions);
+        write_game(*m_boards[i], positions);
+    }
+}
+
+void SelfPlay::run(unsigned nu_games, const string& file)
+{
+    open(file);
+    m_nu_games = nu_games;
+    m_nu_games_started = 0;
+    auto nu_threads = static_cast<unsigned>(m_searches.size());
+    vector<exception_ptr> errors(nu_threads);
+    vector<thread> threads;
+    auto play = [&](unsigned i) {
+        try
+        {
+            play_games(i);
+        }
+        catch (...)
+        {
+            errors[i] = current_exception();
+            // Let the other threads stop after their current game
+            m_nu_games_started = m_nu_games;
+        }
+    };
+    for (unsigned i = 1; i < nu_threads; ++i)
+        threads.emplace_back(play, i);
+    play(0);
+    for (auto& t : threads)
+        t.join();
+    m_out.close();
+    for (auto& e : errors)
+        if (e)
+            rethrow_exception(e);
+}
+
+void SelfPlay::write_game(const Board& bd, const vector<Position>& positions)
+{
+    array<float, Color::range> result;
+    get_result(bd, result);
+    auto nu_players = bd.get_nu_players();
+    unsigned nu_moves_3 = 0;
+    ostringstream out;
+    write_binary(out, static_cast<uint_least16_t>(positions.size()));
+    for (auto& pos : positions)
+    {
+        auto c = pos.to_play;
+        unsigned player;
+        if (m_variant == Variant::classic_3 && c == Color(3))
+            // The fourth color is played alternately by the three players
+            player = nu_moves_3++ % 3;
+        else
+            player = c.to_int() % nu_players;
+        write_binary(out, static_cast<uint_least8_t>(c.to_int()));
+        write_binary(out, pos.mv.to_int());
+        write_binary(out, static_cast<float>(pos.value));
+        write_binary(out, result[player]);
+        write_binary(out, static_cast<uint_least16_t>(pos.children.size()));
+        for (auto& child : pos.children)
+        {
+            write_binary(out, child.first.to_int());
+            write_binary(out, static_cast<float>(child.second));
+        }
+    }
+    auto s = out.str();
+    lock_guard lock(m_mutex);
+    m_out.write(s.data(), static_cast<streamsize>(s.size()));
+    m_out.flush();
+    if (! m_out)
+        throw runtime_error("selfplay: could not write data");
+}
+
+//-----------------------------------------------------------------------------
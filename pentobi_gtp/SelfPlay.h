@@ -0,0 +1,105 @@
+//-----------------------------------------------------------------------------
+/** @file pentobi_gtp/SelfPlay.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef PENTOBI_GTP_SELF_PLAY_H
+#define PENTOBI_GTP_SELF_PLAY_H
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include "libboardgame_base/RandomGenerator.h"
+#include "libpentobi_mcts/Search.h"
+
+using namespace std;
+using libboardgame_base::RandomGenerator;
+using libpentobi_base::Board;
+using libpentobi_base::Variant;
+using libpentobi_mcts::Float;
+using libpentobi_mcts::Search;
+
+//-----------------------------------------------------------------------------
+
+/** Generates training data by letting the search play games against itself.
+    The games are played in parallel with one single-threaded search per
+    thread. All searches share the BoardConst of the game variant.
+    The first moves of each game are sampled according to the visit counts
+    of the root children to get different games, the other moves are the
+    moves selected by the search.
+
+    The data is appended to a binary file in the native byte order, which
+    starts with a 16-byte identifier, the game variant as returned by
+    to_string_id() padded with zeros to 32 bytes and the move range of the
+    board type as a 32-bit integer. Each game is written when it is finished
+    and starts with the number of positions (16-bit). For each position, the
+    file contains:
+    - the color to play (8-bit)
+    - the move played (Move::IntType)
+    - the value of the best move of the search for the color to play
+      (float)
+    - the game result for the player of the color to play (float, 0 for a
+      loss, 1 for a win, fractional values for draws and places in
+      multi-player game variants)
+    - the number of root children (16-bit) followed by the move
+      (Move::IntType) and visit count (float) of each root child
+    The positions can be reconstructed by playing the moves in order. */
+class SelfPlay
+{
+public:
+    /** Constructor.
+        @param variant
+        @param nu_threads The number of games played in parallel.
+        @param simulations The number of simulations per move.
+        @param nu_sampled_moves The number of moves at the beginning of
+        each game that are sampled according to the visit counts. */
+    SelfPlay(Variant variant, unsigned nu_threads, Float simulations,
+             unsigned nu_sampled_moves);
+
+    ~SelfPlay();
+
+    /** Play games and append their data to a file.
+        @throws runtime_error If the file cannot be written or contains data
+        of a different game variant. */
+    void run(unsigned nu_games, const string& file);
+
+private:
+    struct Position;
+
+
+    Variant m_variant;
+
+    Float m_simulations;
+
+    unsigned m_nu_sampled_moves;
+
+    unsigned m_nu_games;
+
+    atomic<unsigned> m_nu_games_started;
+
+    /** Protects the output file. */
+    mutex m_mutex;
+
+    ofstream m_out;
+
+    /** One search per thread. */
+    vector<unique_ptr<Search>> m_searches;
+
+    vector<unique_ptr<Board>> m_boards;
+
+    vector<unique_ptr<RandomGenerator>> m_random;
+
+
+    void open(const string& file);
+
+    void play_game(unsigned i, vector<Position>& positions);
+
+    void play_games(unsigned i);
+
+    void write_game(const Board& bd, const vector<Position>& positions);
+};
+
+//-----------------------------------------------------------------------------
+
+#endif // PENTOBI_GTP_SELF_PLAY_H
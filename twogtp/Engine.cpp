@@ -0,0 +1,33 @@
+//-----------------------------------------------------------------------------
+/** @file twogtp/Engine.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "Engine.h"
+
+#include <sstream>
+#include "ExternalEngine.h"
+#include "InternalEngine.h"
+
+//-----------------------------------------------------------------------------
+
+Engine::~Engine() = default;
+
+unique_ptr<Engine> Engine::create(const string& command, Variant variant,
+                                  size_t max_memory)
+{
+    if (is_internal(command))
+        return make_unique<InternalEngine>(command, variant, max_memory);
+    return make_unique<ExternalEngine>(command, variant);
+}
+
+bool Engine::is_internal(const string& command)
+{
+    istringstream in(command);
+    string s;
+    in >> s;
+    return s == "internal";
+}
+
+//-----------------------------------------------------------------------------
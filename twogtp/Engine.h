@@ -0,0 +1,64 @@
+//-----------------------------------------------------------------------------
+/** @file twogtp/Engine.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef TWOGTP_ENGINE_H
+#define TWOGTP_ENGINE_H
+
+#include <memory>
+#include <string>
+#include "libpentobi_base/Board.h"
+
+using namespace std;
+using libpentobi_base::Color;
+using libpentobi_base::Move;
+using libpentobi_base::Variant;
+
+//-----------------------------------------------------------------------------
+
+/** Player in the games played by TwoGtp. */
+class Engine
+{
+public:
+    /** Create an engine.
+        @param command The command for invoking a GTP engine in an external
+        process (see ExternalEngine) or, if the command starts with
+        "internal", the parameters of a player running in this process (see
+        InternalEngine).
+        @param variant
+        @param max_memory The maximum memory for the search of an internal
+        engine. */
+    static unique_ptr<Engine> create(const string& command, Variant variant,
+                                     size_t max_memory);
+
+    /** Check if a command creates an InternalEngine. */
+    static bool is_internal(const string& command);
+
+    virtual ~Engine();
+
+    virtual void enable_log(const string& prefix) = 0;
+
+    /** Start a new game with an empty board. */
+    virtual void clear_board() = 0;
+
+    /** Play a move of another player or a move that should be played
+        instead of a generated move. */
+    virtual void play(Color c, Move mv) = 0;
+
+    /** Generate and play a move.
+        @param c
+        @param[out] mv
+        @return @c false if the engine resigns. */
+    virtual bool genmove(Color c, Move& mv) = 0;
+
+    /** Get the CPU time used by the engine in seconds. */
+    virtual double get_cputime() = 0;
+
+    virtual void quit() = 0;
+};
+
+//-----------------------------------------------------------------------------
+
+#endif // TWOGTP_ENGINE_H
@@ -0,0 +1,81 @@
+//-----------------------------------------------------------------------------
+/** @file twogtp/ExternalEngine.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "ExternalEngine.h"
+
+#include <sstream>
+
+//-----------------------------------------------------------------------------
+
+ExternalEngine::ExternalEngine(const string& command, Variant variant)
+    : m_variant(variant),
+      m_bc(BoardConst::get(variant)),
+      m_connection(command)
+{
+    if (get_nu_colors(variant) == 2)
+    {
+        m_colors[0] = "b";
+        m_colors[1] = "w";
+    }
+    else
+    {
+        m_colors[0] = "1";
+        m_colors[1] = "2";
+        m_colors[2] = "3";
+        m_colors[3] = "4";
+    }
+}
+
+void ExternalEngine::clear_board()
+{
+    // Send the game variant before the first game, not in the constructor,
+    // such that it is logged after enable_log()
+    if (! m_is_game_set)
+    {
+        m_connection.send(string("set_game ") + to_string(m_variant));
+        m_is_game_set = true;
+    }
+    m_connection.send("clear_board");
+}
+
+void ExternalEngine::enable_log(const string& prefix)
+{
+    m_connection.enable_log(prefix);
+}
+
+bool ExternalEngine::genmove(Color c, Move& mv)
+{
+    auto response = m_connection.send("genmove " + m_colors[c.to_int()]);
+    if (response == "resign")
+        return false;
+    if (! m_bc.from_string(mv, response))
+        throw runtime_error("invalid move");
+    return true;
+}
+
+double ExternalEngine::get_cputime()
+{
+    string response = m_connection.send("cputime");
+    istringstream in(response);
+    double cputime;
+    in >> cputime;
+    if (! in)
+        throw runtime_error("invalid response to cputime: " + response);
+    return cputime;
+}
+
+void ExternalEngine::play(Color c, Move mv)
+{
+    m_connection.send("play " + m_colors[c.to_int()] + " "
+                      + m_bc.to_string(mv));
+}
+
+void ExternalEngine::quit()
+{
+    m_connection.send("quit");
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------------
+/** @file twogtp/ExternalEngine.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef TWOGTP_EXTERNAL_ENGINE_H
+#define TWOGTP_EXTERNAL_ENGINE_H
+
+#include <array>
+#include "Engine.h"
+#include "GtpConnection.h"
+
+using libpentobi_base::BoardConst;
+
+//-----------------------------------------------------------------------------
+
+/** GTP engine in an external process. */
+class ExternalEngine
+    : public Engine
+{
+public:
+    ExternalEngine(const string& command, Variant variant);
+
+    void enable_log(const string& prefix) override;
+
+    void clear_board() override;
+
+    void play(Color c, Move mv) override;
+
+    bool genmove(Color c, Move& mv) override;
+
+    double get_cputime() override;
+
+    void quit() override;
+
+private:
+    bool m_is_game_set = false;
+
+    Variant m_variant;
+
+    const BoardConst& m_bc;
+
+    GtpConnection m_connection;
+
+    array<string, Color::range> m_colors;
+};
+
+//-----------------------------------------------------------------------------
+
+#endif // TWOGTP_EXTERNAL_ENGINE_H
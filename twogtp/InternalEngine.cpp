@@ -0,0 +1,158 @@
+//-----------------------------------------------------------------------------
+/** @file twogtp/InternalEngine.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "InternalEngine.h"
+
+#include <ctime>
+#include <sstream>
+#include "libboardgame_base/StringUtil.h"
+
+using libpentobi_mcts::Float;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+double get_thread_cputime()
+{
+    timespec t;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t) != 0)
+        return 0;
+    return double(t.tv_sec) + 1e-9 * double(t.tv_nsec);
+}
+
+template<typename T>
+T get_value(const string& name, const string& value)
+{
+    T t;
+    if (! libboardgame_base::from_string(value, t))
+        throw runtime_error("invalid value for " + name + ": " + value);
+    return t;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+InternalEngine::InternalEngine(const string& command, Variant variant,
+                               size_t max_memory)
+    : m_bd(make_unique<Board>(variant))
+{
+    istringstream in(command);
+    string s;
+    in >> s;
+    LIBBOARDGAME_ASSERT(s == "internal");
+    vector<pair<string, string>> params;
+    unsigned level = 4;
+    string books_dir;
+    while (in >> s)
+    {
+        auto pos = s.find('=');
+        if (pos == string::npos)
+            throw runtime_error("invalid parameter for internal engine: " + s);
+        auto name = s.substr(0, pos);
+        auto value = s.substr(pos + 1);
+        if (name == "level")
+        {
+            level = get_value<unsigned>(name, value);
+            if (level < 1 || level > Player::max_supported_level)
+                throw runtime_error("invalid level");
+        }
+        else if (name == "threads")
+        {
+            // get_cputime() only measures the CPU time of the game thread
+            if (get_value<unsigned>(name, value) != 1)
+                throw runtime_error(
+                        "internal engine supports only threads=1");
+        }
+        else if (name == "books")
+            books_dir = value;
+        else
+            params.emplace_back(name, value);
+    }
+    m_player = make_unique<Player>(variant, level, books_dir, 1, max_memory);
+    m_player->set_level(level);
+    m_player->set_use_book(! books_dir.empty());
+    for (auto& i : params)
+        set_param(i.first, i.second);
+}
+
+InternalEngine::~InternalEngine() = default;
+
+void InternalEngine::clear_board()
+{
+    m_bd->init();
+}
+
+void InternalEngine::enable_log([[maybe_unused]] const string& prefix)
+{
+    // The player writes to the log of this process
+}
+
+bool InternalEngine::genmove(Color c, Move& mv)
+{
+    auto time = get_thread_cputime();
+    mv = m_player->genmove(*m_bd, c);
+    m_cputime += get_thread_cputime() - time;
+    if (mv.is_null())
+        throw runtime_error("internal engine generated no move");
+    if (m_resign && m_player->resign())
+        return false;
+    m_bd->play(c, mv);
+    return true;
+}
+
+double InternalEngine::get_cputime()
+{
+    return m_cputime;
+}
+
+void InternalEngine::play(Color c, Move mv)
+{
+    m_bd->play(c, mv);
+}
+
+void InternalEngine::quit()
+{
+}
+
+void InternalEngine::set_param(const string& name, const string& value)
+{
+    auto& p = *m_player;
+    auto& s = p.get_search();
+    if (name == "avoid_symmetric_draw")
+        s.set_avoid_symmetric_draw(get_value<bool>(name, value));
+    else if (name == "endgame_solver")
+        p.set_use_endgame_solver(get_value<bool>(name, value));
+    else if (name == "exploration_constant")
+        s.set_exploration_constant(get_value<Float>(name, value));
+    else if (name == "fixed_simulations")
+        p.set_fixed_simulations(get_value<Float>(name, value));
+    else if (name == "fixed_time")
+        p.set_fixed_time(get_value<double>(name, value));
+    else if (name == "nu_thread_groups")
+        s.set_nu_thread_groups(max(get_value<unsigned>(name, value), 1u));
+    else if (name == "rave_child_max")
+        s.set_rave_child_max(get_value<Float>(name, value));
+    else if (name == "rave_parent_max")
+        s.set_rave_parent_max(get_value<Float>(name, value));
+    else if (name == "rave_weight")
+        s.set_rave_weight(get_value<Float>(name, value));
+    else if (name == "resign")
+        m_resign = get_value<bool>(name, value);
+    else if (name == "reuse_subtree")
+        s.set_reuse_subtree(get_value<bool>(name, value));
+    else if (name == "solver")
+        s.set_use_solver(get_value<bool>(name, value));
+    else if (name == "transposition_table")
+        s.set_use_transposition_table(get_value<bool>(name, value));
+    else if (name == "use_book")
+        p.set_use_book(get_value<bool>(name, value));
+    else
+        throw runtime_error("unknown parameter for internal engine: " + name);
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+//-----------------------------------------------------------------------------
+/** @file twogtp/InternalEngine.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef TWOGTP_INTERNAL_ENGINE_H
+#define TWOGTP_INTERNAL_ENGINE_H
+
+#include "Engine.h"
+#include "libpentobi_mcts/Player.h"
+
+using libpentobi_base::Board;
+using libpentobi_mcts::Player;
+
+//-----------------------------------------------------------------------------
+
+/** Player of libpentobi_mcts running in the same process.
+    Avoids the process creation of ExternalEngine and the text GTP commands
+    for each move. All engines in the process share the precomputed move
+    tables of BoardConst.
+    The player is configured with the command "internal" followed by
+    parameters of the form name=value. The names are level, threads (number
+    of threads in the search, only 1 is supported), books (directory with the
+    opening books, books are not used if not specified), resign (default 1)
+    and the parameters of the GTP command param of pentobi-gtp.
+    The CPU time is measured with the CPU time of the game thread, which runs
+    the search. A multi-threaded search is not supported, because the CPU
+    time of the other search threads would not be included. Run several
+    games in parallel instead. */
+class InternalEngine
+    : public Engine
+{
+public:
+    InternalEngine(const string& command, Variant variant, size_t max_memory);
+
+    ~InternalEngine() override;
+
+    void enable_log(const string& prefix) override;
+
+    void clear_board() override;
+
+    void play(Color c, Move mv) override;
+
+    bool genmove(Color c, Move& mv) override;
+
+    double get_cputime() override;
+
+    void quit() override;
+
+private:
+    bool m_resign = true;
+
+    double m_cputime = 0;
+
+    unique_ptr<Board> m_bd;
+
+    unique_ptr<Player> m_player;
+
+    void set_param(const string& name, const string& value);
+};
+
+//-----------------------------------------------------------------------------
+
+#endif // TWOGTP_INTERNAL_ENGINE_H
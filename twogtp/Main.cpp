@@ -9,10 +9,14 @@
 #include "Analyze.h"
 #include "TwoGtp.h"
 #include "libboardgame_base/Log.h"
+#include "libboardgame_base/Memory.h"
 #include "libboardgame_base/Options.h"
+#include "libboardgame_base/StringUtil.h"
 #include "libpentobi_base/Variant.h"
 
 using namespace std;
+using libboardgame_base::from_string;
+using libboardgame_base::split;
 using libboardgame_base::Options;
 using libpentobi_base::Variant;
 
@@ -25,7 +29,9 @@ int main(int argc, char** argv)
     try
     {
         vector<string> specs = {
+            "alpha:",
             "analyze:",
+            "beta:",
             "black|b:",
             "fastopen",
             "file|f:",
@@ -33,6 +39,7 @@ int main(int argc, char** argv)
             "nugames|n:",
             "quiet",
             "saveinterval:",
+            "sprt:",
             "threads:",
             "tree",
             "white|w:",
@@ -59,6 +66,26 @@ int main(int argc, char** argv)
         if (! parse_variant_id(variant_string, variant))
             throw runtime_error("invalid game variant " + variant_string);
         Output output(variant, prefix, create_tree);
+        if (opt.contains("sprt"))
+        {
+            auto elo = split(opt.get("sprt"), ',');
+            double elo0;
+            double elo1;
+            if (elo.size() != 2 || ! from_string(elo[0], elo0)
+                    || ! from_string(elo[1], elo1))
+                throw runtime_error("invalid SPRT bounds " + opt.get("sprt"));
+            output.enable_sprt(elo0, elo1, opt.get<double>("alpha", 0.05),
+                               opt.get<double>("beta", 0.05));
+        }
+        // Internal engines share a quarter of the physical memory
+        size_t nu_internal = 0;
+        if (Engine::is_internal(black))
+            nu_internal += nu_threads;
+        if (Engine::is_internal(white))
+            nu_internal += nu_threads;
+        size_t max_memory = 0;
+        if (nu_internal > 0)
+            max_memory = libboardgame_base::get_memory() / 4 / nu_internal;
         vector<shared_ptr<TwoGtp>> twogtps;
         twogtps.reserve(nu_threads);
         for (unsigned i = 0; i < nu_threads; ++i)
@@ -68,7 +95,8 @@ int main(int argc, char** argv)
                 log_prefix = to_string(i + 1);
             auto twogtp = make_shared<TwoGtp>(black, white, variant,
                                               nu_games, output, quiet,
-                                              log_prefix, fast_open);
+                                              log_prefix, fast_open,
+                                              max_memory);
             twogtp->set_save_interval(save_interval);
             twogtps.push_back(twogtp);
         }
@@ -89,6 +117,19 @@ int main(int argc, char** argv)
             });
         for (auto& t : threads)
             t.join();
+        // The writer thread may still process the last results
+        output.stop_writer();
+        switch (output.get_sprt_decision())
+        {
+        case Sprt::Decision::accept_h0:
+            LIBBOARDGAME_LOG("SPRT: H0 accepted");
+            break;
+        case Sprt::Decision::accept_h1:
+            LIBBOARDGAME_LOG("SPRT: H1 accepted");
+            break;
+        case Sprt::Decision::none:
+            break;
+        }
     }
     catch (const exception& e)
     {
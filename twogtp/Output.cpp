@@ -12,11 +12,35 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/file.h>
+#include "libboardgame_base/Log.h"
 #include "libboardgame_base/StringUtil.h"
 
 using libboardgame_base::from_string;
 using libboardgame_base::split;
 using libboardgame_base::trim;
+using libpentobi_base::ColorMove;
+
+//-----------------------------------------------------------------------------
+
+/** Result of a game passed to the writer thread. */
+struct Output::Record
+{
+    Record* next;
+
+    unsigned player_black;
+
+    float result;
+
+    /** The line for the .dat file. */
+    string line;
+
+    string sgf;
+
+    /** The moves of the game, only used if the tree is created. */
+    vector<ColorMove> moves;
+
+    array<bool, Board::max_moves> is_real_move;
+};
 
 //-----------------------------------------------------------------------------
 
@@ -30,35 +54,88 @@ Output::Output(Variant variant, const string& prefix, bool create_tree)
         throw runtime_error("Output: could not create lock file");
     if (flock(m_lock_fd, LOCK_EX | LOCK_NB) == -1)
         throw runtime_error("Output: twogtp already running");
-    m_timer.reset(m_time_source);
-    ifstream in(prefix + ".dat");
-    if (! in)
-        return;
-    string line;
-    while (getline(in, line))
+    bool has_dat;
     {
-        line = trim(line);
-        if (! line.empty() && line[0] == '#')
-            continue;
-        auto columns = split(line, '\t');
-        if (columns.empty())
-            continue;
-        unsigned game_number;
-        if (! from_string(columns[0], game_number))
-            throw runtime_error("Output: expected game number");
-        m_games.insert({game_number, line});
+        ifstream in(prefix + ".dat");
+        has_dat = static_cast<bool>(in);
+        string line;
+        while (getline(in, line))
+        {
+            line = trim(line);
+            if (! line.empty() && line[0] == '#')
+                continue;
+            auto columns = split(line, '\t');
+            if (columns.empty())
+                continue;
+            unsigned game_number;
+            if (! from_string(columns[0], game_number))
+                throw runtime_error("Output: expected game number");
+            float result;
+            if (columns.size() < 2 || ! from_string(columns[1], result))
+                throw runtime_error("Output: expected result");
+            m_games.insert({game_number, result});
+            m_stat_result.add(result);
+        }
     }
     while (m_games.count(m_next) != 0)
         ++m_next;
     if (check_sentinel())
         remove((prefix + ".stop").c_str());
-    if (m_create_tree && m_next > 0)
-        m_output_tree.load(prefix + "-tree.blksgf");
+    auto tree_file = prefix + "-tree.blksgf";
+    auto tree_log_file = prefix + "-tree.log";
+    if (m_create_tree && ! m_games.empty())
+    {
+        if (ifstream(tree_file))
+            m_output_tree.load(tree_file);
+        // Games added since the tree was last written
+        if (ifstream(tree_log_file))
+            m_output_tree.load_log(tree_log_file);
+    }
+    m_dat_out.open(prefix + ".dat", ios::app);
+    if (! has_dat)
+        m_dat_out << "# Game\tResult\tLength\tPlayerB\tCpuB\tCpuW\tFast\n";
+    m_sgf_out.open(prefix + ".blksgf", ios::app);
+    if (m_create_tree)
+    {
+        bool append = ! m_games.empty();
+        // If the last record of the log is incomplete, it must not be
+        // continued by the next record
+        bool is_line_start = true;
+        if (append)
+        {
+            ifstream in(tree_log_file);
+            if (in.seekg(-1, ios::end))
+                is_line_start = (in.get() == '\n');
+        }
+        m_tree_log_out.open(tree_log_file, append ? ios::app : ios::trunc);
+        if (! is_line_start)
+            m_tree_log_out << '\n';
+    }
+    if (! m_dat_out || ! m_sgf_out || (m_create_tree && ! m_tree_log_out))
+        throw runtime_error("Output: could not open output files");
+    m_bd = make_unique<Board>(variant);
+    m_timer.reset(m_time_source);
+    m_writer = thread(&Output::run_writer, this);
 }
 
 Output::~Output()
 {
-    save();
+    stop_writer();
+    if (m_create_tree)
+    {
+        try
+        {
+            m_output_tree.save(m_prefix + "-tree.blksgf");
+            // If the run is interrupted before the log is cleared, its games
+            // are counted twice in the tree when the run is resumed
+            m_tree_log_out.close();
+            remove((m_prefix + "-tree.log").c_str());
+        }
+        catch (const exception& e)
+        {
+            LIBBOARDGAME_LOG("Error: ", e.what());
+        }
+    }
     flock(m_lock_fd, LOCK_UN);
     close(m_lock_fd);
     remove((m_prefix + ".lock").c_str());
@@ -69,30 +146,35 @@ void Output::add_result(unsigned n, float result, const Board& bd,
                         double cpu_white, const string& sgf,
                         const array<bool, Board::max_moves>& is_real_move)
 {
+    auto record = make_unique<Record>();
+    unsigned nu_fast_open = 0;
+    for (unsigned i = 0; i < bd.get_nu_moves(); ++i)
+        if (! is_real_move[i])
+            ++nu_fast_open;
+    ostringstream line;
+    line << n << '\t'
+         << setprecision(4) << result << '\t'
+         << bd.get_nu_moves() << '\t'
+         << player_black << '\t'
+         << setprecision(5) << cpu_black << '\t'
+         << cpu_white << '\t'
+         << nu_fast_open;
+    record->player_black = player_black;
+    record->result = result;
+    record->line = line.str();
+    record->sgf = sgf;
+    if (m_create_tree)
     {
-        lock_guard lock(m_mutex);
-        unsigned nu_fast_open = 0;
         for (unsigned i = 0; i < bd.get_nu_moves(); ++i)
-            if (! is_real_move[i])
-                ++nu_fast_open;
-        ostringstream line;
-        line << n << '\t'
-             << setprecision(4) << result << '\t'
-             << bd.get_nu_moves() << '\t'
-             << player_black << '\t'
-             << setprecision(5) << cpu_black << '\t'
-             << cpu_white << '\t'
-             << nu_fast_open;
-        m_games.insert({n, line.str()});
-        m_sgf_buffer << sgf;
-        if (m_create_tree)
-            m_output_tree.add_game(bd, player_black, result, is_real_move);
-    }
-    if (m_timer() > m_save_interval)
-    {
-        save();
-        m_timer.reset();
+            record->moves.push_back(bd.get_move(i));
+        record->is_real_move = is_real_move;
     }
+    auto head = record.release();
+    head->next = m_queue.load(memory_order_relaxed);
+    while (! m_queue.compare_exchange_weak(head->next, head,
+                                           memory_order_release,
+                                           memory_order_relaxed));
+    m_wakeup.notify_one();
 }
 
 bool Output::check_sentinel()
@@ -100,40 +182,161 @@ bool Output::check_sentinel()
     return ! ifstream(m_prefix + ".stop").fail();
 }
 
+void Output::enable_sprt(double elo0, double elo1, double alpha, double beta)
+{
+    lock_guard lock(m_mutex);
+    m_sprt = make_unique<Sprt>(elo0, elo1, alpha, beta);
+    for (auto& i : m_games)
+        m_sprt->add(i.second);
+    if (m_games.empty())
+        return;
+    log_statistics();
+    if (m_sprt->get_decision() != Sprt::Decision::none)
+        m_is_finished = true;
+}
+
+void Output::flush()
+{
+    m_dat_out.flush();
+    m_sgf_out.flush();
+    if (m_create_tree)
+        m_tree_log_out.flush();
+}
+
 bool Output::generate_fast_open_move(bool is_player_black, const Board& bd,
                                      Color to_play, Move& mv)
 {
-    lock_guard lock(m_mutex);
+    lock_guard lock(m_tree_mutex);
     m_output_tree.generate_move(is_player_black, bd, to_play, mv);
     return ! mv.is_null();
 }
 
 unsigned Output::get_next()
 {
-    lock_guard lock(m_mutex);
-    unsigned n = m_next;
+    unsigned n;
     do
-       ++m_next;
-    while (m_games.count(m_next) != 0);
+        n = m_next.fetch_add(1);
+    while (m_games.count(n) != 0);
     return n;
 }
 
-void Output::save()
+Sprt::Decision Output::get_sprt_decision()
 {
     lock_guard lock(m_mutex);
+    if (! m_sprt)
+        return Sprt::Decision::none;
+    return m_sprt->get_decision();
+}
+
+void Output::log_statistics()
+{
+    auto mean = m_stat_result.get_mean();
+    auto error = m_stat_result.get_error();
+    auto elo_error = (Sprt::get_elo(mean + error)
+                      - Sprt::get_elo(mean - error)) / 2;
+    ostringstream s;
+    s << fixed << setprecision(1) << "Gam "
+      << static_cast<unsigned>(m_stat_result.get_count())
+      << ", Res " << mean * 100 << u8"±" << error * 100
+      << ", Elo " << Sprt::get_elo(mean) << u8"±" << elo_error;
+    if (m_sprt)
+        s << setprecision(2) << ", LLR " << m_sprt->get_llr() << " ["
+          << m_sprt->get_lower_bound() << ',' << m_sprt->get_upper_bound()
+          << ']';
+    LIBBOARDGAME_LOG(s.str());
+}
+
+void Output::run_writer()
+{
+    while (true)
     {
-        ofstream out(m_prefix + ".dat");
-        out << "# Game\tResult\tLength\tPlayerB\tCpuB\tCpuW\tFast\n";
-        for (auto& i : m_games)
-            out << i.second << '\n';
+        if (check_sentinel())
+            m_is_finished = true;
+        auto records = m_queue.exchange(nullptr, memory_order_acquire);
+        if (records == nullptr)
+        {
+            unique_lock lock(m_wakeup_mutex);
+            if (m_stop_writer && m_queue.load() == nullptr)
+                break;
+            // Use a timeout because add_result() does not hold the mutex
+            // and the notification can get lost. This also limits the delay
+            // for detecting the sentinel file.
+            m_wakeup.wait_for(lock, chrono::milliseconds(100), [&] {
+                return m_stop_writer || m_queue.load() != nullptr;
+            });
+            continue;
+        }
+        // Reverse the stack to write the records in the order they were
+        // added
+        Record* record = nullptr;
+        while (records != nullptr)
+        {
+            auto next = records->next;
+            records->next = record;
+            record = records;
+            records = next;
+        }
+        while (record != nullptr)
+        {
+            unique_ptr<Record> r(record);
+            record = r->next;
+            try
+            {
+                write(*r);
+            }
+            catch (const exception& e)
+            {
+                LIBBOARDGAME_LOG("Error: ", e.what());
+                m_is_finished = true;
+            }
+        }
+        if (m_timer() > m_save_interval)
+        {
+            flush();
+            m_timer.reset();
+        }
     }
+    flush();
+}
+
+void Output::stop_writer()
+{
+    if (! m_writer.joinable())
+        return;
     {
-        ofstream out(m_prefix + ".blksgf", ios::app);
-        out << m_sgf_buffer.str();
-        m_sgf_buffer.str("");
+        lock_guard lock(m_wakeup_mutex);
+        m_stop_writer = true;
     }
+    m_wakeup.notify_one();
+    m_writer.join();
+}
+
+void Output::write(const Record& record)
+{
+    m_dat_out << record.line << '\n';
+    m_sgf_out << record.sgf;
     if (m_create_tree)
-        m_output_tree.save(m_prefix + "-tree.blksgf");
+    {
+        m_bd->init();
+        for (auto& mv : record.moves)
+            m_bd->play(mv);
+        {
+            lock_guard lock(m_tree_mutex);
+            m_output_tree.add_game(*m_bd, record.player_black, record.result,
+                                   record.is_real_move);
+        }
+        OutputTree::write_log(m_tree_log_out, *m_bd, record.player_black,
+                              record.result, record.is_real_move);
+    }
+    lock_guard lock(m_mutex);
+    m_stat_result.add(record.result);
+    if (m_sprt)
+    {
+        m_sprt->add(record.result);
+        if (m_sprt->get_decision() != Sprt::Decision::none)
+            m_is_finished = true;
+    }
+    log_statistics();
 }
 
 //-----------------------------------------------------------------------------
@@ -7,10 +7,15 @@
 #ifndef TWOGTP_OUTPUT_H
 #define TWOGTP_OUTPUT_H
 
-#include <string>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
 #include <map>
 #include <mutex>
+#include <string>
+#include <thread>
 #include "OutputTree.h"
+#include "Sprt.h"
 #include "libboardgame_base/Timer.h"
 #include "libboardgame_base/WallTimeSource.h"
 
@@ -19,7 +24,13 @@ using libboardgame_base::WallTimeSource;
 
 //-----------------------------------------------------------------------------
 
-/** Handles the output files of TwoGtp and their concurrent access. */
+/** Handles the output files of TwoGtp and their concurrent access.
+    The results of the games are passed to a writer thread through a
+    lock-free queue, so the game threads never wait for the files to be
+    written. The writer thread appends the results to the files, updates the
+    statistics and checks if the match should stop. The tree of opening moves
+    is persisted with a log of the added games, the full tree is written
+    only in the destructor. */
 class Output
 {
 public:
@@ -27,6 +38,7 @@ public:
 
     ~Output();
 
+    /** Set the interval for flushing the output files. */
     void set_save_interval(double seconds) { m_save_interval = seconds; }
 
     void add_result(unsigned n, float result, const Board& bd,
@@ -34,37 +46,110 @@ public:
                     const string& sgf,
                     const array<bool, Board::max_moves>& is_real_move);
 
+    /** Enable the sequential probability ratio test for the result of the
+        first engine.
+        The results of games from a previous run are added to the test.
+        See Sprt for the parameters. */
+    void enable_sprt(double elo0, double elo1, double alpha, double beta);
+
+    /** Get the decision of the sequential probability ratio test.
+        Returns Sprt::Decision::none if the test is not enabled. The
+        decision includes only the results already processed by the writer
+        thread, call stop_writer() first to get the final decision. */
+    Sprt::Decision get_sprt_decision();
+
     unsigned get_next();
 
-    bool check_sentinel();
+    /** Check if no more games should be started.
+        True if the sentinel file exists or the sequential probability ratio
+        test has reached a decision. Updated by the writer thread. */
+    bool is_finished() const { return m_is_finished.load(); }
 
     bool generate_fast_open_move(bool is_player_black, const Board& bd,
                                  Color to_play, Move& mv);
 
+    /** Process the remaining results and stop the writer thread.
+        Must be called after all games have finished. No more results may be
+        added after this call. Called by the destructor if it was not called
+        before. */
+    void stop_writer();
+
 private:
-    bool m_create_tree;
+    struct Record;
 
-    unsigned m_next = 0;
+
+    bool m_create_tree;
 
     int m_lock_fd;
 
+    atomic<unsigned> m_next{0};
+
+    atomic<bool> m_is_finished{false};
+
+    atomic<double> m_save_interval{60};
+
     string m_prefix;
 
+    /** Results of the games of a previous run.
+        Not modified after the construction. */
+    map<unsigned, float> m_games;
+
+    /** Head of the queue of results not yet processed by the writer thread.
+        The queue is a lock-free stack, the writer thread takes all records
+        at once and processes them in the order they were added. */
+    atomic<Record*> m_queue{nullptr};
+
+    /** Protects the statistics. */
     mutex m_mutex;
 
-    map<unsigned, string> m_games;
+    /** Results of the first engine in all games. */
+    Statistics<> m_stat_result;
+
+    unique_ptr<Sprt> m_sprt;
+
+    /** Protects the tree, which is also used by the game threads for
+        generating fast opening moves. */
+    mutex m_tree_mutex;
 
     OutputTree m_output_tree;
 
-    ostringstream m_sgf_buffer;
+    mutex m_wakeup_mutex;
+
+    condition_variable m_wakeup;
+
+    bool m_stop_writer = false;
+
+    /** The following members are only used by the writer thread. */
+    /** @{ */
+
+    ofstream m_dat_out;
+
+    ofstream m_sgf_out;
+
+    ofstream m_tree_log_out;
+
+    unique_ptr<Board> m_bd;
 
     WallTimeSource m_time_source;
 
     Timer m_timer;
 
-    double m_save_interval = 60;
+    /** @} */
+
+    thread m_writer;
+
+
+    bool check_sentinel();
+
+    void flush();
+
+    /** Log the current statistics.
+        Requires that the caller holds m_mutex. */
+    void log_statistics();
+
+    void write(const Record& record);
 
-    void save();
+    void run_writer();
 };
 
 //-----------------------------------------------------------------------------
@@ -6,16 +6,20 @@
 
 #include "OutputTree.h"
 
+#include <cstdio>
 #include <fstream>
+#include "libboardgame_base/StringUtil.h"
 #include "libboardgame_base/TreeReader.h"
 #include "libboardgame_base/TreeWriter.h"
 #include "libpentobi_base/BoardUtil.h"
 
 using libboardgame_base::ArrayList;
+using libboardgame_base::from_string;
 using libboardgame_base::SgfNode;
 using libboardgame_base::TreeReader;
 using libboardgame_base::TreeWriter;
 using libpentobi_base::get_transforms;
+using libpentobi_base::BoardConst;
 using libpentobi_base::ColorMove;
 using libpentobi_base::MovePoints;
 using libpentobi_base::get_transformed;
@@ -24,6 +28,9 @@ using libpentobi_base::get_transformed;
 
 namespace {
 
+/** Last token of a complete record in the change log. */
+const string log_end_marker = ";";
+
 void add(PentobiTree& tree, const SgfNode& node, bool is_player_black,
          bool is_real_move, float result)
 {
@@ -227,11 +234,83 @@ void OutputTree::load(const string& file)
     m_tree.init(tree);
 }
 
+void OutputTree::load_log(const string& file)
+{
+    ifstream in(file);
+    auto variant = m_tree.get_variant();
+    auto& bc = BoardConst::get(variant);
+    auto bd = make_unique<Board>(variant);
+    array<bool, Board::max_moves> is_real_move;
+    string line;
+    while (getline(in, line))
+    {
+        istringstream line_in(line);
+        vector<string> tokens;
+        string s;
+        while (line_in >> s)
+            tokens.push_back(s);
+        if (tokens.empty() || tokens.back() != log_end_marker)
+            // Incomplete record of an interrupted run
+            continue;
+        unsigned player_black;
+        float result;
+        if (tokens.size() < 3 || ! from_string(tokens[0], player_black)
+                || ! from_string(tokens[1], result))
+            throw runtime_error("OutputTree: invalid log entry: " + line);
+        bd->init();
+        for (size_t i = 2; i < tokens.size() - 1; ++i)
+        {
+            s = tokens[i];
+            // Moves are written as color:move with a trailing '*' for moves
+            // generated from the tree
+            bool is_real = (s.back() != '*');
+            if (! is_real)
+                s.pop_back();
+            auto pos = s.find(':');
+            unsigned c;
+            Move mv;
+            if (pos == string::npos
+                    || ! from_string(s.substr(0, pos), c)
+                    || c >= bd->get_nu_colors()
+                    || ! bc.from_string(mv, s.substr(pos + 1))
+                    || bd->get_nu_moves() >= Board::max_moves)
+                throw runtime_error("OutputTree: invalid log entry: " + line);
+            is_real_move[bd->get_nu_moves()] = is_real;
+            bd->play(Color(static_cast<Color::IntType>(c)), mv);
+        }
+        add_game(*bd, player_black, result, is_real_move);
+    }
+}
+
 void OutputTree::save(const string& file)
 {
-    ofstream out(file);
-    TreeWriter writer(out, m_tree.get_root());
-    writer.write();
+    auto tmp_file = file + ".tmp";
+    {
+        ofstream out(tmp_file);
+        TreeWriter writer(out, m_tree.get_root());
+        writer.write();
+        if (! out)
+            throw runtime_error("OutputTree: could not write " + file);
+    }
+    if (rename(tmp_file.c_str(), file.c_str()) != 0)
+        throw runtime_error("OutputTree: could not write " + file);
+}
+
+void OutputTree::write_log(ostream& out, const Board& bd,
+                           unsigned player_black, float result,
+                           const array<bool, Board::max_moves>& is_real_move)
+{
+    out << player_black << ' ' << result;
+    auto& bc = bd.get_board_const();
+    for (unsigned i = 0; i < bd.get_nu_moves(); ++i)
+    {
+        auto mv = bd.get_move(i);
+        out << ' ' << static_cast<unsigned>(mv.color.to_int()) << ':'
+            << bc.to_string(mv.move);
+        if (! is_real_move[i])
+            out << '*';
+    }
+    out << ' ' << log_end_marker << '\n';
 }
 
 //-----------------------------------------------------------------------------
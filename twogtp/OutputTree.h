@@ -43,6 +43,14 @@ public:
 
     void load(const string& file);
 
+    /** Add the games of a change log written with write_log().
+        Incomplete records written by an interrupted run are ignored.
+        @throws runtime_error If a complete record is invalid. */
+    void load_log(const string& file);
+
+    /** Write the tree.
+        The file is written to a temporary file and renamed, so an interrupted
+        run never leaves a partially written tree. */
     void save(const string& file);
 
     /** Generate a move for a player from the tree.
@@ -59,6 +67,16 @@ public:
     void add_game(const Board& bd, unsigned player_black, float result,
                   const array<bool, Board::max_moves>& is_real_move);
 
+    /** Write a game as a line of the change log.
+        The change log allows persisting the tree incrementally by appending
+        the games instead of rewriting the whole tree. The games are written
+        in their original orientation and converted by add_game() when the
+        log is loaded. Each record ends with an end marker, so a record that
+        was cut off by an interrupted run is not loaded as a shorter game. */
+    static void write_log(ostream& out, const Board& bd,
+                          unsigned player_black, float result,
+                          const array<bool, Board::max_moves>& is_real_move);
+
 private:
     using PointTransform = libboardgame_base::PointTransform<Point>;
 
@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+/** @file twogtp/Sprt.cpp
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#include "Sprt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+/** Minimum variance of the game results used in the log-likelihood ratio.
+    Avoids an infinite ratio and premature decisions if all games had the
+    same result so far. */
+const double min_variance = 0.05;
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+Sprt::Sprt(double elo0, double elo1, double alpha, double beta)
+    : m_score0(get_score(elo0)),
+      m_score1(get_score(elo1)),
+      m_lower_bound(log(beta / (1 - alpha))),
+      m_upper_bound(log((1 - beta) / alpha))
+{
+    if (elo0 >= elo1)
+        throw runtime_error("SPRT needs elo0 < elo1");
+    if (alpha <= 0 || alpha >= 1 || beta <= 0 || beta >= 1)
+        throw runtime_error("SPRT needs error probabilities in (0,1)");
+}
+
+void Sprt::add(double result)
+{
+    m_statistics.add(result);
+}
+
+Sprt::Decision Sprt::get_decision() const
+{
+    auto llr = get_llr();
+    if (llr >= m_upper_bound)
+        return Decision::accept_h1;
+    if (llr <= m_lower_bound)
+        return Decision::accept_h0;
+    return Decision::none;
+}
+
+double Sprt::get_elo(double score)
+{
+    score = min(max(score, 1e-3), 1 - 1e-3);
+    return -400 * log10(1 / score - 1);
+}
+
+double Sprt::get_llr() const
+{
+    auto count = m_statistics.get_count();
+    if (count == 0)
+        return 0;
+    auto mean = m_statistics.get_mean();
+    auto variance = max(m_statistics.get_variance(), min_variance);
+    return count * (m_score1 - m_score0) * (2 * mean - m_score0 - m_score1)
+            / (2 * variance);
+}
+
+double Sprt::get_score(double elo)
+{
+    return 1 / (1 + pow(10, -elo / 400));
+}
+
+//-----------------------------------------------------------------------------
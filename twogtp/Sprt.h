@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+/** @file twogtp/Sprt.h
+    @author Markus Enzenberger
+    @copyright GNU General Public License version 3 or later */
+//-----------------------------------------------------------------------------
+
+#ifndef TWOGTP_SPRT_H
+#define TWOGTP_SPRT_H
+
+#include "libboardgame_base/Statistics.h"
+
+using libboardgame_base::Statistics;
+
+//-----------------------------------------------------------------------------
+
+/** Sequential probability ratio test for the result of a match.
+    Tests the hypothesis H0 that the Elo difference of the first player is
+    elo0 against the hypothesis H1 that it is elo1 with the error
+    probabilities alpha and beta. The log-likelihood ratio is computed with
+    the normal approximation of the generalized SPRT, which does not depend
+    on the distribution of the game results, so it can be used with draws
+    and with the fractional results of multi-player game variants. */
+class Sprt
+{
+public:
+    enum class Decision
+    {
+        none,
+
+        accept_h0,
+
+        accept_h1
+    };
+
+
+    /** Convert a mean game result to an Elo difference. */
+    static double get_elo(double score);
+
+    /** Convert an Elo difference to an expected game result. */
+    static double get_score(double elo);
+
+
+    Sprt(double elo0, double elo1, double alpha, double beta);
+
+    void add(double result);
+
+    /** Get the log-likelihood ratio of H1 against H0. */
+    double get_llr() const;
+
+    /** Lower bound of the log-likelihood ratio for accepting H0. */
+    double get_lower_bound() const { return m_lower_bound; }
+
+    /** Upper bound of the log-likelihood ratio for accepting H1. */
+    double get_upper_bound() const { return m_upper_bound; }
+
+    Decision get_decision() const;
+
+    const Statistics<>& get_statistics() const { return m_statistics; }
+
+private:
+    double m_score0;
+
+    double m_score1;
+
+    double m_lower_bound;
+
+    double m_upper_bound;
+
+    Statistics<> m_statistics;
+};
+
+//-----------------------------------------------------------------------------
+
+#endif // TWOGTP_SPRT_H
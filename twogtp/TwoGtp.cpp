@@ -8,9 +8,11 @@
 
 #include "libboardgame_base/Log.h"
 #include "libboardgame_base/Writer.h"
+#include "libpentobi_base/PentobiSgfUtil.h"
 #include "libpentobi_base/ScoreUtil.h"
 
 using libboardgame_base::Writer;
+using libpentobi_base::get_color_id;
 using libpentobi_base::get_multiplayer_result;
 using libpentobi_base::Move;
 using libpentobi_base::ScoreType;
@@ -19,32 +21,20 @@ using libpentobi_base::ScoreType;
 
 TwoGtp::TwoGtp(const string& black, const string& white, Variant variant,
                unsigned nu_games, Output& output, bool quiet,
-               const string& log_prefix, bool fast_open)
+               const string& log_prefix, bool fast_open, size_t max_memory)
     : m_quiet(quiet),
       m_fast_open(fast_open),
       m_variant(variant),
       m_nu_games(nu_games),
       m_bd(variant),
       m_output(output),
-      m_black(black),
-      m_white(white)
+      m_black(Engine::create(black, variant, max_memory)),
+      m_white(Engine::create(white, variant, max_memory))
 {
     if (! m_quiet)
     {
-        m_black.enable_log(log_prefix + "B");
-        m_white.enable_log(log_prefix + "W");
-    }
-    if (get_nu_colors(m_variant) == 2)
-    {
-        m_colors[0] = "b";
-        m_colors[1] = "w";
-    }
-    else
-    {
-        m_colors[0] = "1";
-        m_colors[1] = "2";
-        m_colors[2] = "3";
-        m_colors[3] = "4";
+        m_black->enable_log(log_prefix + "B");
+        m_white->enable_log(log_prefix + "W");
     }
 }
 
@@ -84,9 +74,10 @@ void TwoGtp::play_game(unsigned game_number)
                          "Game ", game_number, "\n"
                          "================================================");
     m_bd.init();
-    send_both("clear_board");
-    auto cpu_black = send_cputime(m_black);
-    auto cpu_white = send_cputime(m_white);
+    m_black->clear_board();
+    m_white->clear_board();
+    auto cpu_black = m_black->get_cputime();
+    auto cpu_white = m_white->get_cputime();
     unsigned nu_players = m_bd.get_nu_players();
     unsigned player_black = game_number % nu_players;
     bool resign = false;
@@ -107,9 +98,8 @@ void TwoGtp::play_game(unsigned game_number)
             player = m_bd.get_alt_player();
         else
             player = to_play.to_int() % nu_players;
-        auto& player_connection = (player == player_black ? m_black : m_white);
-        auto& other_connection = (player == player_black ? m_white : m_black);
-        auto color = m_colors[to_play.to_int()];
+        auto& player_engine = (player == player_black ? *m_black : *m_white);
+        auto& other_engine = (player == player_black ? *m_white : *m_black);
         Move mv;
         if (m_fast_open
                 && m_output.generate_fast_open_move(player == player_black,
@@ -117,31 +107,28 @@ void TwoGtp::play_game(unsigned game_number)
         {
             is_real_move[m_bd.get_nu_moves()] = false;
             LIBBOARDGAME_LOG("Playing fast opening move");
-            player_connection.send("play " + color + " " + m_bd.to_string(mv));
+            player_engine.play(to_play, mv);
         }
         else
         {
             is_real_move[m_bd.get_nu_moves()] = true;
-            auto response = player_connection.send("genmove " + color);
-            if (response == "resign")
+            if (! player_engine.genmove(to_play, mv))
             {
                 resign = true;
                 break;
             }
-            if (! m_bd.from_string(mv, response))
-                throw runtime_error("invalid move");
         }
         sgf.begin_node();
-        sgf.write_property(string(1, static_cast<char>(toupper(color[0]))),
+        sgf.write_property(get_color_id(m_variant, to_play),
                            m_bd.to_string(mv));
         sgf.end_node();
         if (mv.is_null() || ! m_bd.is_legal(to_play, mv))
             throw runtime_error("invalid move: " + m_bd.to_string(mv));
         m_bd.play(to_play, mv);
-        other_connection.send("play " + color + " " + m_bd.to_string(mv));
+        other_engine.play(to_play, mv);
     }
-    cpu_black = send_cputime(m_black) - cpu_black;
-    cpu_white = send_cputime(m_white) - cpu_white;
+    cpu_black = m_black->get_cputime() - cpu_black;
+    cpu_white = m_white->get_cputime() - cpu_white;
     float result;
     if (resign)
     {
@@ -159,32 +146,15 @@ void TwoGtp::play_game(unsigned game_number)
 
 void TwoGtp::run()
 {
-    send_both(string("set_game ") + to_string(m_variant));
-    while (! m_output.check_sentinel())
+    while (! m_output.is_finished())
     {
         unsigned n = m_output.get_next();
         if (n >= m_nu_games)
             break;
         play_game(n);
     }
-    send_both("quit");
-}
-
-void TwoGtp::send_both(const string& cmd)
-{
-    m_black.send(cmd);
-    m_white.send(cmd);
-}
-
-double TwoGtp::send_cputime(GtpConnection& gtp_connection)
-{
-    string response = gtp_connection.send("cputime");
-    istringstream in(response);
-    double cputime;
-    in >> cputime;
-    if (! in)
-        throw runtime_error("invalid response to cputime: " + response);
-    return cputime;
+    m_black->quit();
+    m_white->quit();
 }
 
 //-----------------------------------------------------------------------------
@@ -8,7 +8,7 @@
 #define TWOGTP_TWOGTP_H
 
 #include <array>
-#include "GtpConnection.h"
+#include "Engine.h"
 #include "Output.h"
 #include "libpentobi_base/Board.h"
 
@@ -22,9 +22,21 @@ using libpentobi_base::Variant;
 class TwoGtp
 {
 public:
+    /** Constructor.
+        @param black The command for the first engine (see
+        Engine::create())
+        @param white The command for the second engine
+        @param variant
+        @param nu_games
+        @param output
+        @param quiet
+        @param log_prefix
+        @param fast_open
+        @param max_memory The maximum memory for the search of each internal
+        engine. */
     TwoGtp(const string& black, const string& white, Variant variant,
            unsigned nu_games, Output& output, bool quiet,
-           const string& log_prefix, bool fast_open);
+           const string& log_prefix, bool fast_open, size_t max_memory);
 
     void run();
 
@@ -43,19 +55,14 @@ private:
 
     Output& m_output;
 
-    GtpConnection m_black;
+    unique_ptr<Engine> m_black;
 
-    GtpConnection m_white;
-
-    array<string, Color::range> m_colors;
+    unique_ptr<Engine> m_white;
 
     float get_result(unsigned player_black);
 
     void play_game(unsigned game_number);
 
-    void send_both(const string& cmd);
-
-    double send_cputime(GtpConnection& gtp_connection);
 };
 
 //-----------------------------------------------------------------------------